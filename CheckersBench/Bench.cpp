@@ -0,0 +1,458 @@
+/*
+  Microbenchmarks (Google Benchmark).
+  -----------------------------------
+  Times the building blocks of the engine on a fixed corpus of positions:
+  move generation, make/unmake, evaluation, hashing, the transposition
+  table, perft, lock-step batches, notation, PDN reading/writing and
+  rendering.
+
+  The corpus is built from random games with a fixed seed (std::mt19937 is
+  fully specified, so every platform gets the same positions), which keeps
+  numbers comparable between builds and machines of the same kind. Most
+  benchmarks report items per second, where an item is one position.
+
+  Building: the CheckersBench target of the CMake build (skipped when
+  Google Benchmark is not installed), or CheckersBench.vcxproj with the
+  benchmark library from vcpkg ("vcpkg install benchmark").
+
+  For numbers worth comparing, run on an idle machine with the CPU governor
+  pinned and repetitions, e.g.
+    CheckersBench --benchmark_repetitions=5 --benchmark_report_aggregates_only=true
+                  --benchmark_out=bench.json --benchmark_out_format=json
+  and compare two result files with Google Benchmark's tools/compare.py.
+*/
+
+#include "BatchBoard.h"
+#include "Board.h"
+#include "Eval.h"
+#include "Notation.h"
+#include "Pdn.h"
+#include "Perft.h"
+#include "Render.h"
+#include "TransTable.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* ------------------ Corpus ------------------ */
+
+struct BenchPosition {
+    Position pos;
+    Player side;
+    MoveList moves;   // legal moves, never empty
+};
+
+struct Corpus {
+    vector<BenchPosition> positions;
+    vector<PdnGame> games;
+};
+
+constexpr int CORPUS_GAMES = 64;
+constexpr int CORPUS_MAX_PLIES = 120;
+
+// Every position of CORPUS_GAMES random games, and the games themselves
+static Corpus buildCorpus() {
+    Corpus c;
+    mt19937 rng(20240611);
+    for (int g = 0; g < CORPUS_GAMES; g++) {
+        PdnGame game;
+        initBoard(game.start);
+        Position pos = game.start;
+        Player side = WHITE;
+        for (int ply = 0; ply < CORPUS_MAX_PLIES; ply++) {
+            BenchPosition bp{ pos, side, {} };
+            allLegalMoves(pos, side, bp.moves);
+            if (bp.moves.empty()) {
+                game.result = pdnResult(opponent(side));
+                break;
+            }
+            c.positions.push_back(bp);
+
+            const Move& m = bp.moves[rng() % bp.moves.size()];
+            game.moves.push_back(m);
+            Undo undo;
+            makeMove(pos, m, undo);
+            side = opponent(side);
+        }
+        c.games.push_back(game);
+    }
+    return c;
+}
+
+static const Corpus& corpus() {
+    static const Corpus c = buildCorpus();
+    return c;
+}
+
+/* ------------------ Move generation ------------------ */
+
+static void BM_AllLegalMoves(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    MoveList moves;
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            allLegalMoves(bp.pos, bp.side, moves);
+            benchmark::DoNotOptimize(moves.count);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_AllLegalMoves);
+
+static void BM_CapturersMovers(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            benchmark::DoNotOptimize(capturers(bp.pos, bp.side));
+            benchmark::DoNotOptimize(movers(bp.pos, bp.side));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_CapturersMovers);
+
+// Items are moves here: every legal move of every position
+static void BM_MakeUnmake(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    size_t moves = 0;
+    for (const BenchPosition& bp : positions) moves += bp.moves.size();
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            Position pos = bp.pos;
+            for (const Move& m : bp.moves) {
+                Undo undo;
+                makeMove(pos, m, undo);
+                benchmark::DoNotOptimize(pos.key);
+                unmakeMove(pos, m, undo);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves);
+}
+BENCHMARK(BM_MakeUnmake);
+
+static void BM_ApplyMoveCopy(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    size_t moves = 0;
+    for (const BenchPosition& bp : positions) moves += bp.moves.size();
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            for (const Move& m : bp.moves) {
+                Position pos = bp.pos;
+                applyMove(pos, m);
+                maybePromote(pos, m.to);
+                benchmark::DoNotOptimize(pos.key);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * moves);
+}
+BENCHMARK(BM_ApplyMoveCopy);
+
+// Items are perft nodes
+static void BM_Perft(benchmark::State& state) {
+    Position pos;
+    initBoard(pos);
+    int depth = (int)state.range(0);
+    uint64_t nodes = 0;
+    for (auto _ : state) {
+        nodes = perft(pos, WHITE, depth);
+        benchmark::DoNotOptimize(nodes);
+    }
+    state.SetItemsProcessed(state.iterations() * nodes);
+}
+BENCHMARK(BM_Perft)->Arg(6)->Arg(8)->Unit(benchmark::kMillisecond);
+
+/* ------------------ Lock-step batches ------------------ */
+
+static BoardBatch corpusBatch() {
+    const auto& positions = corpus().positions;
+    BoardBatch batch;
+    batch.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) batch.set(i, positions[i].pos, positions[i].side);
+    return batch;
+}
+
+// BM_AllLegalMoves for the corpus as one batch
+static void BM_BatchLegalMoves(benchmark::State& state) {
+    BoardBatch batch = corpusBatch();
+    BatchMoveList moves;
+    for (auto _ : state) {
+        batchLegalMoves(batch, moves);
+        benchmark::DoNotOptimize(moves.moves.data());
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+BENCHMARK(BM_BatchLegalMoves);
+
+static void BM_BatchCapturersMovers(benchmark::State& state) {
+    BoardBatch batch = corpusBatch();
+    vector<uint32_t> capt(batch.size()), mov(batch.size());
+    for (auto _ : state) {
+        batchCapturers(batch, capt.data());
+        batchMovers(batch, mov.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * batch.size());
+}
+BENCHMARK(BM_BatchCapturersMovers);
+
+constexpr int PLAYOUT_BOARDS = 4096;
+
+// Cheap move choice for the playouts: xorshift32
+static uint32_t nextRandom(uint32_t& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+/*
+  Random games in lock-step, restarted when they end: one iteration is one
+  ply on every board. Items are plies.
+*/
+static void BM_BatchPlayout(benchmark::State& state) {
+    BoardBatch batch;
+    batch.resize(PLAYOUT_BOARDS);
+    BatchMoveList moves;
+    vector<Move> chosen(PLAYOUT_BOARDS);
+    Position start;
+    initBoard(start);
+    MoveList opening;
+    allLegalMoves(start, WHITE, opening);
+    uint32_t rng = 1;
+    for (auto _ : state) {
+        batchLegalMoves(batch, moves);
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (moves.count(i) == 0 || batch.noProgressDraw(i)) {
+                batch.set(i, start, WHITE);
+                chosen[i] = opening[nextRandom(rng) % opening.size()];
+            }
+            else chosen[i] = moves.move(i, nextRandom(rng) % moves.count(i));
+        }
+        batchApplyMoves(batch, chosen.data());
+    }
+    state.SetItemsProcessed(state.iterations() * PLAYOUT_BOARDS);
+}
+BENCHMARK(BM_BatchPlayout);
+
+// The same playouts with the scalar functions, board by board
+static void BM_ScalarPlayout(benchmark::State& state) {
+    vector<Position> boards(PLAYOUT_BOARDS);
+    vector<Player> sides(PLAYOUT_BOARDS, WHITE);
+    vector<int> quiet(PLAYOUT_BOARDS, 0);
+    for (Position& p : boards) initBoard(p);
+    MoveList moves;
+    uint32_t rng = 1;
+    for (auto _ : state) {
+        for (size_t i = 0; i < boards.size(); i++) {
+            allLegalMoves(boards[i], sides[i], moves);
+            if (moves.empty() || quiet[i] >= NO_PROGRESS_PLIES) {
+                initBoard(boards[i]);
+                sides[i] = WHITE;
+                quiet[i] = 0;
+                allLegalMoves(boards[i], WHITE, moves);
+            }
+            const Move& m = moves[nextRandom(rng) % moves.size()];
+            quiet[i] = isProgress(boards[i], m) ? 0 : quiet[i] + 1;
+            applyMove(boards[i], m);
+            maybePromote(boards[i], m.to);
+            sides[i] = opponent(sides[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * PLAYOUT_BOARDS);
+}
+BENCHMARK(BM_ScalarPlayout);
+
+/* ------------------ Evaluation ------------------ */
+
+static void BM_Evaluate(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions)
+            benchmark::DoNotOptimize(evaluate(bp.pos, bp.side));
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_Evaluate);
+
+static void BM_EvaluateBatch(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    size_t n = positions.size();
+    vector<uint32_t> white(n), black(n), kings(n);
+    vector<uint8_t> side(n);
+    vector<int> scores(n);
+    for (size_t i = 0; i < n; i++) {
+        white[i] = positions[i].pos.white;
+        black[i] = positions[i].pos.black;
+        kings[i] = positions[i].pos.kings;
+        side[i] = (uint8_t)positions[i].side;
+    }
+    PositionBatch batch = { white.data(), black.data(), kings.data(), side.data(), n };
+    for (auto _ : state) {
+        evaluateBatch(batch, scores.data());
+        benchmark::DoNotOptimize(scores.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_EvaluateBatch);
+
+/* ------------------ Hashing ------------------ */
+
+static void BM_RefreshKey(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            Position pos = bp.pos;
+            refreshKey(pos);
+            benchmark::DoNotOptimize(positionKey(pos, bp.side));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_RefreshKey);
+
+// One store and one probe per position, in a table much larger than the corpus
+static void BM_TransTable(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    TransTable tt(16);
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions) {
+            uint64_t key = positionKey(bp.pos, bp.side);
+            tt.store(key, 4, 0, BOUND_EXACT, moveCode(bp.moves[0]));
+            TTEntry e;
+            benchmark::DoNotOptimize(tt.probe(key, e));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_TransTable);
+
+/* ------------------ Notation ------------------ */
+
+static void BM_PositionFen(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions)
+            benchmark::DoNotOptimize(positionFen(bp.pos, bp.side));
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_PositionFen);
+
+static void BM_ParseFen(benchmark::State& state) {
+    vector<string> fens;
+    for (const BenchPosition& bp : corpus().positions) fens.push_back(positionFen(bp.pos, bp.side));
+    for (auto _ : state) {
+        for (const string& fen : fens) {
+            Position pos;
+            Player side;
+            benchmark::DoNotOptimize(parseFen(fen, pos, side));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * fens.size());
+}
+BENCHMARK(BM_ParseFen);
+
+// Items are moves: the legal move matching its PDN text
+static void BM_ParsePdnMove(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    vector<string> texts;
+    for (const BenchPosition& bp : positions) texts.push_back(pdnMoveName(bp.moves[0]));
+    for (auto _ : state) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            Move m;
+            benchmark::DoNotOptimize(parsePdnMove(texts[i], positions[i].pos, positions[i].side, m));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_ParsePdnMove);
+
+/* ------------------ PDN files ------------------ */
+
+// The corpus games as one PDN file, in a temporary file
+static FILE* corpusPdnFile() {
+    FILE* f = tmpfile();
+    if (!f) return nullptr;
+    for (const PdnGame& g : corpus().games) writePdnGame(f, g);
+    fflush(f);
+    return f;
+}
+
+// Items are games, bytes are the file size
+static void BM_PdnRead(benchmark::State& state) {
+    FILE* f = corpusPdnFile();
+    if (!f) {
+        state.SkipWithError("cannot create a temporary file");
+        return;
+    }
+    PdnGame game;
+    uint64_t games = 0, bytes = 0;
+    for (auto _ : state) {
+        rewind(f);
+        PdnReader reader(f);
+        while (reader.next(game)) games++;
+        bytes += reader.bytesRead();
+    }
+    fclose(f);
+    state.SetItemsProcessed(games);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_PdnRead);
+
+static void BM_PdnWrite(benchmark::State& state) {
+    FILE* f = tmpfile();
+    if (!f) {
+        state.SkipWithError("cannot create a temporary file");
+        return;
+    }
+    const auto& games = corpus().games;
+    for (auto _ : state) {
+        rewind(f);
+        for (const PdnGame& g : games) writePdnGame(f, g);
+        fflush(f);
+    }
+    fclose(f);
+    state.SetItemsProcessed(state.iterations() * games.size());
+}
+BENCHMARK(BM_PdnWrite);
+
+/* ------------------ Rendering ------------------ */
+
+// Frames are composed, not written to the terminal
+static void BM_RenderFull(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    ConsoleRenderer renderer;
+    const string status = "\nTurn: WHITE (Player 1)\nEnter move: ";
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions)
+            benchmark::DoNotOptimize(renderer.compose(bp.pos, status).size());
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_RenderFull);
+
+// Consecutive corpus positions are consecutive plies, as in a real game
+static void BM_RenderDiff(benchmark::State& state) {
+    const auto& positions = corpus().positions;
+    ConsoleRenderer renderer;
+    renderer.setDiffMode(true);
+    const string status = "\nTurn: WHITE (Player 1)\nEnter move: ";
+    for (auto _ : state) {
+        for (const BenchPosition& bp : positions)
+            benchmark::DoNotOptimize(renderer.compose(bp.pos, status).size());
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK(BM_RenderDiff);
+
+BENCHMARK_MAIN();
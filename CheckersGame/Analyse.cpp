@@ -0,0 +1,130 @@
+/*
+  Batch position analysis (see Analyse.h).
+*/
+
+#include "Analyse.h"
+#include "Eval.h"
+#include "Notation.h"
+#include "Perft.h"
+#include "Search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct AnalyseOptions {
+    SearchLimits limits;
+    int perftDepth = 0;    // > 0: count nodes instead of searching
+    size_t hashMb = 16;    // per worker
+};
+
+static string analyseLine(const string& line, const AnalyseOptions& opt, Searcher& searcher, TransTable& tt) {
+    string fen = line.substr(0, line.find(';'));
+    while (!fen.empty() && isspace((unsigned char)fen.back())) fen.pop_back();
+
+    Position pos;
+    Player side;
+    if (!parseFen(fen, pos, side)) return fen + " ; error bad FEN";
+
+    if (opt.perftDepth > 0)
+        return fen + " ; perft " + to_string(opt.perftDepth) + " " + to_string(perft(pos, side, opt.perftDepth));
+
+    tt.clear();
+    SearchResult r = searcher.search(pos, side, opt.limits);
+    if (!r.hasMove) return fen + " ; nomove";
+    return fen + " ; bestmove " + pdnMoveName(r.best) + " score " + to_string(r.score)
+        + " depth " + to_string(r.depth) + " nodes " + to_string(r.nodes) + " time " + to_string(r.timeMs);
+}
+
+int analyseCommand(int argc, char* argv[]) {
+    if (argc < 1) {
+        fprintf(stderr, "usage: analyse FILE [--depth D] [--movetime MS] [--perft D] [--jobs N] [--hash MB] [--tb FILE] [--eval FILE] [--out FILE]\n");
+        return 1;
+    }
+
+    AnalyseOptions opt;
+    opt.limits.maxDepth = 10;
+    int jobs = max(1u, thread::hardware_concurrency());
+    const char* outPath = nullptr;
+    Tablebase tablebase;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool ok = i + 1 < argc;
+        const char* val = ok ? argv[i + 1] : "";
+        if (arg == "--depth" && ok) opt.limits.maxDepth = atoi(val);
+        else if (arg == "--movetime" && ok) opt.limits.moveTimeMs = atoi(val);
+        else if (arg == "--perft" && ok) opt.perftDepth = atoi(val);
+        else if (arg == "--jobs" && ok) jobs = max(1, atoi(val));
+        else if (arg == "--hash" && ok) opt.hashMb = (size_t)atoi(val);
+        else if (arg == "--tb" && ok) ok = tablebase.open(val);
+        else if (arg == "--eval" && ok) ok = loadEvalWeights(val);
+        else if (arg == "--out" && ok) outPath = val;
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "analyse: bad option '%s'\n", arg.c_str());
+            return 1;
+        }
+        i++;
+    }
+
+    ifstream in(argv[0]);
+    if (!in) {
+        fprintf(stderr, "analyse: cannot open %s\n", argv[0]);
+        return 1;
+    }
+    vector<string> lines;
+    for (string line; getline(in, line); ) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == string::npos || line[first] == '#') continue;
+        lines.push_back(line.substr(first));
+    }
+
+    FILE* out = outPath ? fopen(outPath, "wb") : stdout;
+    if (!out) {
+        fprintf(stderr, "analyse: cannot open %s\n", outPath);
+        return 1;
+    }
+
+    // Workers take the next position; results are printed in input order
+    // as soon as every earlier one is done
+    vector<string> results(lines.size());
+    vector<atomic<bool>> done(lines.size());
+    atomic<size_t> next{ 0 };
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> pool;
+    for (int j = 0; j < jobs; j++) {
+        pool.emplace_back([&] {
+            TransTable tt(opt.hashMb);
+            Searcher searcher(tt);
+            if (tablebase.isOpen()) searcher.setTablebase(&tablebase);
+            for (size_t i; (i = next.fetch_add(1)) < lines.size(); ) {
+                results[i] = analyseLine(lines[i], opt, searcher, tt);
+                done[i].store(true, memory_order_release);
+            }
+        });
+    }
+    for (size_t i = 0; i < lines.size(); i++) {
+        while (!done[i].load(memory_order_acquire)) this_thread::sleep_for(chrono::milliseconds(1));
+        fprintf(out, "%s\n", results[i].c_str());
+        fflush(out);
+    }
+    for (auto& t : pool) t.join();
+    if (out != stdout) fclose(out);
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%zu positions in %.2fs (%d jobs)\n", lines.size(), secs, jobs);
+    return 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+/*
+  Batch position analysis.
+  ------------------------
+  Reads a file with one FEN position per line (see Notation.h; anything
+  after a ';' is ignored, blank lines and lines starting with '#' are
+  skipped), analyses the positions on several worker threads and writes
+  one result line per position, in input order:
+
+    B:W18,K25:B6,10 ; bestmove 10-14 score 95 depth 12 nodes 81234 time 40
+    B:W21-32:B1-12 ; perft 8 845931
+    X:bad ; error bad FEN
+
+  Command line:
+    analyse FILE [--depth D] [--movetime MS] [--perft D] [--jobs N]
+                 [--hash MB] [--tb FILE] [--eval FILE] [--out FILE]
+  Default: search to depth 10.
+*/
+
+int analyseCommand(int argc, char* argv[]);
@@ -0,0 +1,341 @@
+/*
+  Lock-step batches of games (see BatchBoard.h).
+*/
+
+#include "BatchBoard.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+// GCC 12 flags the deliberately undefined register inside many AVX-512 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+using namespace std;
+
+// Square layout and directions of Board.cpp
+static constexpr uint32_t EVEN_ROWS = 0x0F0F0F0Fu;
+static constexpr uint32_t ODD_ROWS = 0xF0F0F0F0u;
+static constexpr uint32_t COL_A = 0x10101010u;
+static constexpr uint32_t COL_H = 0x08080808u;
+static constexpr uint32_t ROW_0 = 0x0000000Fu;
+static constexpr uint32_t ROW_7 = 0xF0000000u;
+
+enum Dir {
+    DOWN_LEFT = 0,
+    DOWN_RIGHT = 1,
+    UP_LEFT = 2,
+    UP_RIGHT = 3
+};
+
+// Square index change of a step in each direction, from even and from odd rows
+static constexpr int STEP_DELTA[4][2] = { { 4, 3 }, { 5, 4 }, { -4, -5 }, { -3, -4 } };
+
+static_assert(sizeof(Move) == 16, "the gathers below read a Move as four 32-bit words");
+constexpr int MOVE_WORD_CAPTURED = 2;
+constexpr int MOVE_WORD_SQUARES = 3;   // from | to << 8 | jumps << 16
+
+/* ------------------ Lanes ------------------ */
+
+/*
+  The kernels are written once for a "lanes" type holding one mask of N
+  boards: Lanes1 is a plain uint32_t (the tail of a batch, and builds
+  without SIMD), Wide the widest vector the build allows.
+*/
+struct Lanes1 {
+    static constexpr size_t N = 1;
+    uint32_t v;
+
+    static Lanes1 load(const uint32_t* p) { return { *p }; }
+    static Lanes1 loadSides(const uint8_t* p) { return { *p }; }
+    static Lanes1 fill(uint32_t x) { return { x }; }
+    static Lanes1 gather(const Move* m, int word) {
+        uint32_t w;
+        memcpy(&w, (const char*)m + 4 * word, 4);
+        return { w };
+    }
+    void store(uint32_t* p) const { *p = v; }
+
+    template<int K> Lanes1 shl() const { return { v << K }; }
+    template<int K> Lanes1 shr() const { return { v >> K }; }
+    Lanes1 bitAt() const { return { 1u << v }; }   // 1 << v, v < 32
+
+    friend Lanes1 operator&(Lanes1 a, Lanes1 b) { return { a.v & b.v }; }
+    friend Lanes1 operator|(Lanes1 a, Lanes1 b) { return { a.v | b.v }; }
+    friend Lanes1 operator~(Lanes1 a) { return { ~a.v }; }
+    friend Lanes1 operator+(Lanes1 a, Lanes1 b) { return { a.v + b.v }; }
+    friend Lanes1 eq(Lanes1 a, Lanes1 b) { return { a.v == b.v ? ~0u : 0u }; }   // all ones where equal
+};
+
+#if defined(__AVX512F__)
+
+struct Lanes16 {
+    static constexpr size_t N = 16;
+    __m512i v;
+
+    static Lanes16 load(const uint32_t* p) { return { _mm512_loadu_si512(p) }; }
+    static Lanes16 loadSides(const uint8_t* p) { return { _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)p)) }; }
+    static Lanes16 fill(uint32_t x) { return { _mm512_set1_epi32((int)x) }; }
+    static Lanes16 gather(const Move* m, int word) {
+        __m512i idx = _mm512_add_epi32(_mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60),
+                                       _mm512_set1_epi32(word));
+        return { _mm512_i32gather_epi32(idx, (const int*)m, 4) };
+    }
+    void store(uint32_t* p) const { _mm512_storeu_si512(p, v); }
+
+    template<int K> Lanes16 shl() const { return { _mm512_slli_epi32(v, K) }; }
+    template<int K> Lanes16 shr() const { return { _mm512_srli_epi32(v, K) }; }
+    Lanes16 bitAt() const { return { _mm512_sllv_epi32(_mm512_set1_epi32(1), v) }; }
+
+    friend Lanes16 operator&(Lanes16 a, Lanes16 b) { return { _mm512_and_si512(a.v, b.v) }; }
+    friend Lanes16 operator|(Lanes16 a, Lanes16 b) { return { _mm512_or_si512(a.v, b.v) }; }
+    friend Lanes16 operator~(Lanes16 a) { return { _mm512_xor_si512(a.v, _mm512_set1_epi32(-1)) }; }
+    friend Lanes16 operator+(Lanes16 a, Lanes16 b) { return { _mm512_add_epi32(a.v, b.v) }; }
+    friend Lanes16 eq(Lanes16 a, Lanes16 b) {
+        return { _mm512_maskz_mov_epi32(_mm512_cmpeq_epi32_mask(a.v, b.v), _mm512_set1_epi32(-1)) };
+    }
+};
+using Wide = Lanes16;
+
+#elif defined(__AVX2__)
+
+struct Lanes8 {
+    static constexpr size_t N = 8;
+    __m256i v;
+
+    static Lanes8 load(const uint32_t* p) { return { _mm256_loadu_si256((const __m256i*)p) }; }
+    static Lanes8 loadSides(const uint8_t* p) { return { _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p)) }; }
+    static Lanes8 fill(uint32_t x) { return { _mm256_set1_epi32((int)x) }; }
+    static Lanes8 gather(const Move* m, int word) {
+        __m256i idx = _mm256_add_epi32(_mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28), _mm256_set1_epi32(word));
+        return { _mm256_i32gather_epi32((const int*)m, idx, 4) };
+    }
+    void store(uint32_t* p) const { _mm256_storeu_si256((__m256i*)p, v); }
+
+    template<int K> Lanes8 shl() const { return { _mm256_slli_epi32(v, K) }; }
+    template<int K> Lanes8 shr() const { return { _mm256_srli_epi32(v, K) }; }
+    Lanes8 bitAt() const { return { _mm256_sllv_epi32(_mm256_set1_epi32(1), v) }; }
+
+    friend Lanes8 operator&(Lanes8 a, Lanes8 b) { return { _mm256_and_si256(a.v, b.v) }; }
+    friend Lanes8 operator|(Lanes8 a, Lanes8 b) { return { _mm256_or_si256(a.v, b.v) }; }
+    friend Lanes8 operator~(Lanes8 a) { return { _mm256_xor_si256(a.v, _mm256_set1_epi32(-1)) }; }
+    friend Lanes8 operator+(Lanes8 a, Lanes8 b) { return { _mm256_add_epi32(a.v, b.v) }; }
+    friend Lanes8 eq(Lanes8 a, Lanes8 b) { return { _mm256_cmpeq_epi32(a.v, b.v) }; }
+};
+using Wide = Lanes8;
+
+#else
+
+using Wide = Lanes1;
+
+#endif
+
+// a where m is all ones, b where it is zero
+template<class L> static L select(L m, L a, L b) {
+    return (a & m) | (b & ~m);
+}
+
+template<class L> static L andMask(L a, uint32_t mask) {
+    return a & L::fill(mask);
+}
+
+// shiftDir() of Board.cpp, lane by lane
+template<int DIR, class L> static L shiftDir(L m) {
+    if constexpr (DIR == DOWN_LEFT)
+        return andMask(m, EVEN_ROWS).template shl<4>() | andMask(m, ODD_ROWS & ~COL_A).template shl<3>();
+    else if constexpr (DIR == DOWN_RIGHT)
+        return andMask(m, EVEN_ROWS & ~COL_H).template shl<5>() | andMask(m, ODD_ROWS).template shl<4>();
+    else if constexpr (DIR == UP_LEFT)
+        return andMask(m, EVEN_ROWS).template shr<4>() | andMask(m, ODD_ROWS & ~COL_A).template shr<5>();
+    else
+        return andMask(m, EVEN_ROWS & ~COL_H).template shr<3>() | andMask(m, ODD_ROWS).template shr<4>();
+}
+
+/* ------------------ Kernels ------------------ */
+
+// The masks of boards i .. i + L::N - 1 as seen by their side to move
+template<class L>
+struct SideView {
+    L isWhite;   // all ones where WHITE is to move
+    L own, enemy, kings, empty;
+
+    SideView(const BoardBatch& b, size_t i) {
+        L w = L::load(b.white.data() + i), bl = L::load(b.black.data() + i);
+        isWhite = eq(L::loadSides(b.side.data() + i), L::fill(WHITE));
+        own = select(isWhite, w, bl);
+        enemy = select(isWhite, bl, w);
+        kings = L::load(b.kings.data() + i);
+        empty = ~(w | bl);
+    }
+};
+
+// Squares from which a jump in DIR is possible (an enemy, then an empty square)
+template<int DIR, class L> static L jumpsTowards(const SideView<L>& s) {
+    constexpr int BACK = DIR ^ 3;
+    return shiftDir<BACK>(shiftDir<BACK>(s.empty) & s.enemy);
+}
+
+// capturers(): white men jump down, black men up, kings both ways
+template<class L> static L capturersOf(const SideView<L>& s) {
+    L down = jumpsTowards<DOWN_LEFT>(s) | jumpsTowards<DOWN_RIGHT>(s);
+    L up = jumpsTowards<UP_LEFT>(s) | jumpsTowards<UP_RIGHT>(s);
+    return s.own & (select(s.isWhite, down, up) | (s.kings & select(s.isWhite, up, down)));
+}
+
+// Pieces with a simple move in DIR
+template<int DIR, class L> static L stepsTowards(const SideView<L>& s) {
+    constexpr bool DOWN = (DIR == DOWN_LEFT || DIR == DOWN_RIGHT);
+    L allowed = DOWN ? (s.isWhite | s.kings) : (~s.isWhite | s.kings);
+    return shiftDir<DIR ^ 3>(s.empty) & s.own & allowed;
+}
+
+template<class L> static void capturersKernel(const BoardBatch& b, size_t i, uint32_t* out) {
+    capturersOf(SideView<L>(b, i)).store(out + i);
+}
+
+template<class L> static void moversKernel(const BoardBatch& b, size_t i, uint32_t* out) {
+    SideView<L> s(b, i);
+    L m = stepsTowards<DOWN_LEFT>(s) | stepsTowards<DOWN_RIGHT>(s) | stepsTowards<UP_LEFT>(s) | stepsTowards<UP_RIGHT>(s);
+    m.store(out + i);
+}
+
+template<class L> static void legalKernel(const BoardBatch& b, size_t i, BatchMoveList& out) {
+    SideView<L> s(b, i);
+    capturersOf(s).store(out.capt.data() + i);
+    stepsTowards<DOWN_LEFT>(s).store(out.steps[DOWN_LEFT].data() + i);
+    stepsTowards<DOWN_RIGHT>(s).store(out.steps[DOWN_RIGHT].data() + i);
+    stepsTowards<UP_LEFT>(s).store(out.steps[UP_LEFT].data() + i);
+    stepsTowards<UP_RIGHT>(s).store(out.steps[UP_RIGHT].data() + i);
+}
+
+/*
+  applyMove() + maybePromote() for boards i .. i + L::N - 1. The piece is
+  lifted and dropped (a king's chain may end where it started) and crowned
+  when it ends on the far row as a man.
+*/
+template<class L> static void applyKernel(BoardBatch& b, size_t i, const Move* chosen) {
+    SideView<L> s(b, i);
+    L squares = L::gather(chosen + i, MOVE_WORD_SQUARES);
+    L captured = L::gather(chosen + i, MOVE_WORD_CAPTURED);
+    L fromBit = andMask(squares, 0xFF).bitAt();
+    L toBit = andMask(squares.template shr<8>(), 0xFF).bitAt();
+    L zero = L::fill(0);
+
+    L wasKing = ~eq(s.kings & fromBit, zero);
+    L crown = select(s.isWhite, L::fill(ROW_7), L::fill(ROW_0));
+    L own = (s.own & ~fromBit) | toBit;
+    L enemy = s.enemy & ~captured;
+    L kings = (s.kings & ~(fromBit | captured)) | (toBit & (wasKing | crown));
+
+    // Captures and man moves restart the 40-move count
+    L progress = ~eq(captured, zero) | ~wasKing;
+    L quiet = (L::load(b.quiet.data() + i) + L::fill(1)) & ~progress;
+
+    select(s.isWhite, own, enemy).store(b.white.data() + i);
+    select(s.isWhite, enemy, own).store(b.black.data() + i);
+    kings.store(b.kings.data() + i);
+    quiet.store(b.quiet.data() + i);
+}
+
+/* ------------------ BoardBatch ------------------ */
+
+void BoardBatch::resize(size_t n) {
+    Position start;
+    initBoard(start);
+    white.resize(n, start.white);
+    black.resize(n, start.black);
+    kings.resize(n, start.kings);
+    side.resize(n, WHITE);
+    quiet.resize(n, 0);
+}
+
+void BoardBatch::set(size_t i, const Position& pos, Player toMove) {
+    white[i] = pos.white;
+    black[i] = pos.black;
+    kings[i] = pos.kings;
+    side[i] = (uint8_t)toMove;
+    quiet[i] = 0;
+}
+
+Position BoardBatch::position(size_t i) const {
+    Position pos;
+    pos.white = white[i];
+    pos.black = black[i];
+    pos.kings = kings[i];
+    refreshKey(pos);
+    return pos;
+}
+
+PositionBatch BoardBatch::view() const {
+    return { white.data(), black.data(), kings.data(), side.data(), size() };
+}
+
+/* ------------------ Batched generation ------------------ */
+
+void batchCapturers(const BoardBatch& b, uint32_t* out) {
+    size_t n = b.size(), i = 0;
+    for (; i + Wide::N <= n; i += Wide::N) capturersKernel<Wide>(b, i, out);
+    for (; i < n; i++) capturersKernel<Lanes1>(b, i, out);
+}
+
+void batchMovers(const BoardBatch& b, uint32_t* out) {
+    size_t n = b.size(), i = 0;
+    for (; i + Wide::N <= n; i += Wide::N) moversKernel<Wide>(b, i, out);
+    for (; i < n; i++) moversKernel<Lanes1>(b, i, out);
+}
+
+void batchLegalMoves(const BoardBatch& b, BatchMoveList& out) {
+    size_t n = b.size(), i = 0;
+    out.capt.resize(n);
+    for (auto& s : out.steps) s.resize(n);
+    for (; i + Wide::N <= n; i += Wide::N) legalKernel<Wide>(b, i, out);
+    for (; i < n; i++) legalKernel<Lanes1>(b, i, out);
+
+    // Move lists, from the masks. 'moves' only grows: first[n] is the real count.
+    out.first.resize(n + 1);
+    size_t used = 0;
+    MoveList chains;
+    for (i = 0; i < n; i++) {
+        out.first[i] = (uint32_t)used;
+        if (used + MAX_MOVES > out.moves.size()) out.moves.resize(2 * out.moves.size() + MAX_MOVES);
+        Move* w = out.moves.data() + used;
+
+        if (uint32_t capt = out.capt[i]) {
+            // Men first, then kings, as allCaptures() does
+            Position pos = { b.white[i], b.black[i], b.kings[i], 0 };
+            Player pl = b.turn(i);
+            chains.clear();
+            for (uint32_t m = capt & ~pos.kings; m; m &= m - 1) captureMovesFrom(pos, countr_zero(m), pl, chains);
+            for (uint32_t m = capt & pos.kings; m; m &= m - 1) captureMovesFrom(pos, countr_zero(m), pl, chains);
+            copy(chains.begin(), chains.end(), w);
+            used += chains.size();
+            continue;
+        }
+        for (int dir = 0; dir < 4; dir++) {
+            for (uint32_t m = out.steps[dir][i]; m; m &= m - 1) {
+                int sq = countr_zero(m);
+                int to = sq + STEP_DELTA[dir][(sq >> 2) & 1];
+                *w++ = { 0, 0, (uint8_t)sq, (uint8_t)to, 0 };
+            }
+        }
+        used = w - out.moves.data();
+    }
+    out.first[n] = (uint32_t)used;
+}
+
+void batchApplyMoves(BoardBatch& b, const Move* chosen) {
+    size_t n = b.size(), i = 0;
+    for (; i + Wide::N <= n; i += Wide::N) applyKernel<Wide>(b, i, chosen);
+    for (; i < n; i++) applyKernel<Lanes1>(b, i, chosen);
+    for (uint8_t& s : b.side) s ^= WHITE | BLACK;   // the other player
+}
@@ -0,0 +1,529 @@
+/*
+  Board representation and move generation (core rules).
+  See Board.h for the square numbering.
+
+  Moving one diagonal step is a shift of the mask. Because the dark squares
+  alternate between odd columns (even rows) and even columns (odd rows), the
+  shift amount depends on the row parity:
+
+    direction            even row    odd row
+    down-left  (r+1,c-1)    << 4       << 3   (not from column a)
+    down-right (r+1,c+1)    << 5       << 4   (not from column h)
+    up-left    (r-1,c-1)    >> 4       >> 5   (not from column a)
+    up-right   (r-1,c+1)    >> 3       >> 4   (not from column h)
+
+  Squares shifted past row 0 or row 7 simply fall off the 32-bit mask.
+*/
+
+#include "Board.h"
+#include "Stats.h"
+
+#include <bit>
+
+using namespace std;
+
+/* ------------------ Masks & shifts ------------------ */
+
+static constexpr uint32_t EVEN_ROWS = 0x0F0F0F0Fu;   // rows 0,2,4,6
+static constexpr uint32_t ODD_ROWS = 0xF0F0F0F0u;    // rows 1,3,5,7
+static constexpr uint32_t COL_A = 0x10101010u;       // a-file squares (odd rows)
+static constexpr uint32_t COL_H = 0x08080808u;       // h-file squares (even rows)
+static constexpr uint32_t ROW_0 = 0x0000000Fu;
+static constexpr uint32_t ROW_7 = 0xF0000000u;
+
+// Diagonal directions
+enum Dir {
+    DOWN_LEFT = 0,
+    DOWN_RIGHT = 1,
+    UP_LEFT = 2,
+    UP_RIGHT = 3
+};
+
+static constexpr uint32_t shiftDir(uint32_t m, int dir) {
+    switch (dir) {
+    case DOWN_LEFT:  return ((m & EVEN_ROWS) << 4) | ((m & ODD_ROWS & ~COL_A) << 3);
+    case DOWN_RIGHT: return ((m & EVEN_ROWS & ~COL_H) << 5) | ((m & ODD_ROWS) << 4);
+    case UP_LEFT:    return ((m & EVEN_ROWS) >> 4) | ((m & ODD_ROWS & ~COL_A) >> 5);
+    default:         return ((m & EVEN_ROWS & ~COL_H) >> 3) | ((m & ODD_ROWS) >> 4);
+    }
+}
+
+/*
+  Forward directions:
+  - White moves downward => DOWN_LEFT, DOWN_RIGHT
+  - Black moves upward   => UP_LEFT, UP_RIGHT
+*/
+static constexpr int firstForwardDir(Player pl) {
+    return (pl == WHITE) ? DOWN_LEFT : UP_LEFT;
+}
+
+/*
+  Everything below that depends on the side to move is a template on the
+  Player, so each side gets its own code with its directions, its masks and
+  its crowning row folded in. The runtime functions declared in Board.h
+  pick the instantiation once per call.
+*/
+template<Player PL> static constexpr int FORWARD = firstForwardDir(PL);     // first of two
+template<Player PL> static constexpr int BACKWARD = firstForwardDir(PL) ^ 2;
+template<Player PL> static constexpr int MAN_DIRS = 3 << FORWARD<PL>;       // bit per Dir
+static constexpr int KING_DIRS = 0xF;
+template<Player PL> static constexpr uint32_t CROWN_ROW = (PL == WHITE) ? ROW_7 : ROW_0;
+
+template<Player PL> static uint32_t ownPieces(const Position& pos) {
+    if constexpr (PL == WHITE) return pos.white;
+    else return pos.black;
+}
+template<Player PL> static uint32_t& ownPieces(Position& pos) {
+    if constexpr (PL == WHITE) return pos.white;
+    else return pos.black;
+}
+
+/* ------------------ Square tables ------------------ */
+
+/*
+  Per-square lookups for the generators that work on one piece at a time,
+  built at compile time:
+  - step[sq][dir]: the neighbour of sq in dir (0 off the board)
+  - jump[sq][dir]: the landing square two steps away (0 off the board)
+*/
+struct SquareTables {
+    uint32_t step[32][4];
+    uint32_t jump[32][4];
+};
+
+static constexpr SquareTables makeSquareTables() {
+    constexpr int dRow[4] = { 1, 1, -1, -1 };
+    constexpr int dCol[4] = { -1, 1, -1, 1 };
+    SquareTables t = {};
+    for (int sq = 0; sq < 32; sq++) {
+        for (int dir = 0; dir < 4; dir++) {
+            int r = sqRow(sq) + dRow[dir], c = sqCol(sq) + dCol[dir];
+            if (inBounds(r, c)) t.step[sq][dir] = 1u << squareIndex(r, c);
+            r += dRow[dir];
+            c += dCol[dir];
+            if (inBounds(r, c)) t.jump[sq][dir] = 1u << squareIndex(r, c);
+        }
+    }
+    return t;
+}
+
+static constexpr SquareTables SQUARES = makeSquareTables();
+
+// The tables must agree with the mask shifts used everywhere else
+static constexpr bool squareTablesMatchShifts() {
+    for (int sq = 0; sq < 32; sq++)
+        for (int dir = 0; dir < 4; dir++)
+            if (SQUARES.step[sq][dir] != shiftDir(1u << sq, dir)
+                || SQUARES.jump[sq][dir] != shiftDir(shiftDir(1u << sq, dir), dir))
+                return false;
+    return true;
+}
+static_assert(squareTablesMatchShifts(), "square tables disagree with shiftDir");
+
+/* ------------------ Zobrist keys ------------------ */
+
+// splitmix64: a good 64-bit mixer that also runs at compile time
+static constexpr uint64_t splitmix(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// One random key per (piece, square) plus one for "black to move"
+struct ZobristKeys {
+    uint64_t piece[4][32];   // indexed by Piece - 1
+    uint64_t blackToMove;
+};
+
+static constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys z = {};
+    uint64_t state = 0x436865636B657273ull;
+    for (auto& row : z.piece)
+        for (auto& k : row) k = splitmix(state);
+    z.blackToMove = splitmix(state);
+    return z;
+}
+
+static constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+static uint64_t pieceKey(Piece p, int sq) {
+    return ZOBRIST.piece[p - 1][sq];
+}
+
+void refreshKey(Position& pos) {
+    pos.key = 0;
+    for (uint32_t m = pos.white | pos.black; m; m &= m - 1) {
+        int sq = countr_zero(m);
+        pos.key ^= pieceKey(pieceAt(pos, sq), sq);
+    }
+}
+
+uint64_t positionKey(const Position& pos, Player pl) {
+    return (pl == BLACK) ? pos.key ^ ZOBRIST.blackToMove : pos.key;
+}
+
+/* ------------------ Position queries ------------------ */
+
+Piece pieceAt(const Position& pos, int sq) {
+    uint32_t bit = 1u << sq;
+    bool king = (pos.kings & bit) != 0;
+    if (pos.white & bit) return king ? W_KING : W_MAN;
+    if (pos.black & bit) return king ? B_KING : B_MAN;
+    return EMPTY;
+}
+
+bool isKing(Piece p) {
+    return p == W_KING || p == B_KING;
+}
+
+bool belongsTo(Piece p, Player pl) {
+    if (p == EMPTY) return false;
+    if (pl == WHITE) return p == W_MAN || p == W_KING;
+    return p == B_MAN || p == B_KING;
+}
+
+/* ------------------ Setup ------------------ */
+
+// White men on rows 0..2, black men on rows 5..7, no kings
+void initBoard(Position& pos) {
+    pos.white = 0x00000FFFu;
+    pos.black = 0xFFF00000u;
+    pos.kings = 0;
+    refreshKey(pos);
+}
+
+/* ------------------ Move generation ------------------ */
+
+/*
+  Pieces on 'pieces' that can jump in DIR: the piece, then an enemy, then an
+  empty landing square. Computed backwards from the empty squares so that
+  all pieces are checked in a handful of shifts.
+*/
+template<int DIR>
+static uint32_t jumpersTowards(uint32_t pieces, uint32_t enemy, uint32_t empty) {
+    constexpr int BACK = DIR ^ 3;   // opposite direction
+    return shiftDir(shiftDir(empty, BACK) & enemy, BACK) & pieces;
+}
+
+// Pieces on 'pieces' with an empty square next to them in DIR
+template<int DIR>
+static uint32_t steppersTowards(uint32_t pieces, uint32_t empty) {
+    return shiftDir(empty, DIR ^ 3) & pieces;
+}
+
+// Mask of pieces of PL that can capture (men forward, kings both ways)
+template<Player PL>
+uint32_t capturers(const Position& pos) {
+    uint32_t own = ownPieces<PL>(pos);
+    uint32_t enemy = ownPieces<opponent(PL)>(pos);
+    uint32_t empty = emptySquares(pos);
+    uint32_t kings = own & pos.kings;
+
+    uint32_t res = jumpersTowards<FORWARD<PL>>(own, enemy, empty)
+                 | jumpersTowards<FORWARD<PL> + 1>(own, enemy, empty);
+    if (kings)
+        res |= jumpersTowards<BACKWARD<PL>>(kings, enemy, empty)
+             | jumpersTowards<BACKWARD<PL> + 1>(kings, enemy, empty);
+    return res;
+}
+
+// Mask of pieces of PL that have a simple (one-step) move
+template<Player PL>
+uint32_t movers(const Position& pos) {
+    uint32_t own = ownPieces<PL>(pos);
+    uint32_t empty = emptySquares(pos);
+    uint32_t kings = own & pos.kings;
+
+    uint32_t res = steppersTowards<FORWARD<PL>>(own, empty)
+                 | steppersTowards<FORWARD<PL> + 1>(own, empty);
+    if (kings)
+        res |= steppersTowards<BACKWARD<PL>>(kings, empty)
+             | steppersTowards<BACKWARD<PL> + 1>(kings, empty);
+    return res;
+}
+
+/*
+  Depth-first walk over the capture tree of one piece.
+  - DIRS: directions this piece may jump in (bit per Dir)
+  - sq: where the piece stands now
+  - enemy / empty: board as seen by the moving piece; jumped pieces are
+    removed at once and every square the piece leaves (its starting square
+    included) counts as empty, exactly as when the jumps are played one by one.
+  Every leaf (no further jump possible) is one complete move.
+*/
+template<int DIRS>
+static void jumpDfs(int sq, uint32_t enemy, uint32_t empty, const Move& mv, MoveList& out) {
+    bool extended = false;
+    uint32_t bit = 1u << sq;
+
+    for (int dir = 0; dir < 4; dir++) {
+        if (!(DIRS & (1 << dir))) continue;
+        uint32_t over = SQUARES.step[sq][dir] & enemy;   // enemy position
+        uint32_t land = SQUARES.jump[sq][dir] & empty;   // landing position
+        if (!over || !land) continue;
+
+        int to = countr_zero(land);
+        Move next = mv;
+        next.path |= uint64_t(to) << (5 * next.jumps);
+        next.jumps++;
+        next.captured |= over;
+        next.to = (uint8_t)to;
+
+        jumpDfs<DIRS>(to, enemy & ~over, (empty | over | bit) & ~land, next, out);
+        extended = true;
+    }
+
+    if (!extended && mv.jumps > 0) out.push(mv);
+}
+
+// Every capture chain of the piece on sq (which belongs to PL)
+template<Player PL, int DIRS>
+static void capturesOf(const Position& pos, int sq, MoveList& out) {
+    Move mv = { 0, 0, (uint8_t)sq, (uint8_t)sq, 0 };
+    jumpDfs<DIRS>(sq, ownPieces<opponent(PL)>(pos), emptySquares(pos) | (1u << sq), mv, out);
+}
+
+template<int DIRS>
+static void stepsOf(int sq, uint32_t empty, MoveList& out) {
+    for (int dir = 0; dir < 4; dir++) {
+        if (!(DIRS & (1 << dir))) continue;
+        uint32_t to = SQUARES.step[sq][dir] & empty;
+        if (to) out.push({ 0, 0, (uint8_t)sq, (uint8_t)countr_zero(to), 0 });
+    }
+}
+
+/*
+  Generate all capture moves FROM a single piece at sq.
+  For men:
+    - can capture only forward diagonals (2 steps)
+  For kings:
+    - can capture in all 4 diagonals (2 steps)
+  After a jump the same piece must keep capturing while it can, so every
+  generated move is a complete chain.
+*/
+template<Player PL>
+static void captureMovesFrom(const Position& pos, int sq, MoveList& out) {
+    uint32_t bit = 1u << sq;
+    if (!(ownPieces<PL>(pos) & bit)) return;
+    if (pos.kings & bit) capturesOf<PL, KING_DIRS>(pos, sq, out);
+    else capturesOf<PL, MAN_DIRS<PL>>(pos, sq, out);
+}
+
+/*
+  Generate all simple (non-capture) moves FROM a single piece at sq.
+  For men:
+    - 1 step forward diagonals
+  For kings:
+    - 1 step in any diagonal direction
+*/
+template<Player PL>
+static void simpleMovesFrom(const Position& pos, int sq, MoveList& out) {
+    uint32_t bit = 1u << sq;
+    if (!(ownPieces<PL>(pos) & bit)) return;
+    if (pos.kings & bit) stepsOf<KING_DIRS>(sq, emptySquares(pos), out);
+    else stepsOf<MAN_DIRS<PL>>(sq, emptySquares(pos), out);
+}
+
+/*
+  Collect ALL capture moves available for a player on the whole board.
+  This is important because capturing is mandatory:
+  if any capture exists, player must choose a capture move.
+  Only pieces flagged by capturers() are visited, men first, then kings.
+*/
+template<Player PL>
+void allCaptures(const Position& pos, MoveList& out) {
+    out.clear();
+    uint32_t from = capturers<PL>(pos);
+    for (uint32_t m = from & ~pos.kings; m; m &= m - 1)
+        capturesOf<PL, MAN_DIRS<PL>>(pos, countr_zero(m), out);
+    for (uint32_t m = from & pos.kings; m; m &= m - 1)
+        capturesOf<PL, KING_DIRS>(pos, countr_zero(m), out);
+}
+
+/*
+  Collect ALL legal moves for the player:
+  - If captures exist => only capture moves are legal (mandatory capture rule)
+  - Otherwise => all simple moves are legal
+*/
+template<Player PL>
+void allLegalMoves(const Position& pos, MoveList& out) {
+    STAT_INC(STAT_MOVEGEN_CALLS);
+    allCaptures<PL>(pos, out);
+    if (!out.empty()) {
+        STAT_ADD(STAT_CAPTURES_GENERATED, out.size());
+        return;
+    }
+
+    uint32_t from = movers<PL>(pos);
+    uint32_t empty = emptySquares(pos);
+    for (uint32_t m = from & ~pos.kings; m; m &= m - 1)
+        stepsOf<MAN_DIRS<PL>>(countr_zero(m), empty, out);
+    for (uint32_t m = from & pos.kings; m; m &= m - 1)
+        stepsOf<KING_DIRS>(countr_zero(m), empty, out);
+    STAT_ADD(STAT_QUIETS_GENERATED, out.size());
+}
+
+template uint32_t capturers<WHITE>(const Position&);
+template uint32_t capturers<BLACK>(const Position&);
+template uint32_t movers<WHITE>(const Position&);
+template uint32_t movers<BLACK>(const Position&);
+template void allCaptures<WHITE>(const Position&, MoveList&);
+template void allCaptures<BLACK>(const Position&, MoveList&);
+template void allLegalMoves<WHITE>(const Position&, MoveList&);
+template void allLegalMoves<BLACK>(const Position&, MoveList&);
+
+// Runtime side: one dispatch per call
+uint32_t capturers(const Position& pos, Player pl) {
+    return (pl == WHITE) ? capturers<WHITE>(pos) : capturers<BLACK>(pos);
+}
+
+uint32_t movers(const Position& pos, Player pl) {
+    return (pl == WHITE) ? movers<WHITE>(pos) : movers<BLACK>(pos);
+}
+
+void captureMovesFrom(const Position& pos, int sq, Player pl, MoveList& out) {
+    if (pl == WHITE) captureMovesFrom<WHITE>(pos, sq, out);
+    else captureMovesFrom<BLACK>(pos, sq, out);
+}
+
+void simpleMovesFrom(const Position& pos, int sq, Player pl, MoveList& out) {
+    if (pl == WHITE) simpleMovesFrom<WHITE>(pos, sq, out);
+    else simpleMovesFrom<BLACK>(pos, sq, out);
+}
+
+void allCaptures(const Position& pos, Player pl, MoveList& out) {
+    if (pl == WHITE) allCaptures<WHITE>(pos, out);
+    else allCaptures<BLACK>(pos, out);
+}
+
+void allLegalMoves(const Position& pos, Player pl, MoveList& out) {
+    if (pl == WHITE) allLegalMoves<WHITE>(pos, out);
+    else allLegalMoves<BLACK>(pos, out);
+}
+
+int countPieces(const Position& pos, Player pl) {
+    return popcount(piecesOf(pos, pl));
+}
+
+/* ------------------ Applying moves ------------------ */
+
+/*
+  Apply a move to the board:
+  - Move piece from -> to (king flag travels with it)
+  - Remove every captured enemy
+  A king's chain may end on its starting square, so the piece is lifted
+  and dropped rather than toggled. The key is updated piece by piece.
+*/
+void applyMove(Position& pos, const Move& mv) {
+    STAT_INC(STAT_MOVES_MADE);
+    uint32_t fromBit = 1u << mv.from;
+    uint32_t toBit = 1u << mv.to;
+
+    Piece p = pieceAt(pos, mv.from);
+    pos.key ^= pieceKey(p, mv.from) ^ pieceKey(p, mv.to);
+    for (uint32_t m = mv.captured; m; m &= m - 1) {
+        int sq = countr_zero(m);
+        pos.key ^= pieceKey(pieceAt(pos, sq), sq);
+    }
+
+    uint32_t& own = (pos.white & fromBit) ? pos.white : pos.black;
+    own = (own & ~fromBit) | toBit;
+    if (pos.kings & fromBit) pos.kings = (pos.kings & ~fromBit) | toBit;
+
+    if (mv.captured) {
+        pos.white &= ~mv.captured;
+        pos.black &= ~mv.captured;
+        pos.kings &= ~mv.captured;
+    }
+}
+
+/*
+  Promotion rule:
+  - White man becomes king when it reaches row 7
+  - Black man becomes king when it reaches row 0
+  Note: we promote at end of turn (after chain captures).
+*/
+void maybePromote(Position& pos, int sq) {
+    uint32_t bit = 1u << sq;
+    uint32_t crowned = bit & ~pos.kings & ((pos.white & ROW_7) | (pos.black & ROW_0));
+    if (!crowned) return;
+
+    pos.kings |= crowned;
+    if (pos.white & crowned) pos.key ^= pieceKey(W_MAN, sq) ^ pieceKey(W_KING, sq);
+    else pos.key ^= pieceKey(B_MAN, sq) ^ pieceKey(B_KING, sq);
+}
+
+/*
+  applyMove + maybePromote for a move of PL, remembering what they changed.
+  The mover's colour is known, so only its own and the enemy masks are
+  touched and no square has to be looked up to find which piece it holds.
+*/
+template<Player PL>
+void makeMove(Position& pos, const Move& mv, Undo& undo) {
+    constexpr Piece MAN = (PL == WHITE) ? W_MAN : B_MAN;
+    constexpr Piece KING = (PL == WHITE) ? W_KING : B_KING;
+    constexpr Piece ENEMY_MAN = (PL == WHITE) ? B_MAN : W_MAN;
+    constexpr Piece ENEMY_KING = (PL == WHITE) ? B_KING : W_KING;
+    uint32_t fromBit = 1u << mv.from;
+    uint32_t toBit = 1u << mv.to;
+    uint32_t& own = ownPieces<PL>(pos);
+    uint32_t& enemy = ownPieces<opponent(PL)>(pos);
+    STAT_INC(STAT_MOVES_MADE);
+
+    undo.key = pos.key;
+    undo.capturedKings = pos.kings & mv.captured;
+
+    bool king = (pos.kings & fromBit) != 0;
+    Piece p = king ? KING : MAN;
+    pos.key ^= pieceKey(p, mv.from) ^ pieceKey(p, mv.to);
+    for (uint32_t m = mv.captured; m; m &= m - 1) {
+        int sq = countr_zero(m);
+        pos.key ^= pieceKey((undo.capturedKings >> sq) & 1 ? ENEMY_KING : ENEMY_MAN, sq);
+    }
+
+    own = (own & ~fromBit) | toBit;
+    enemy &= ~mv.captured;
+    pos.kings &= ~mv.captured;
+    if (king) pos.kings = (pos.kings & ~fromBit) | toBit;
+
+    undo.promoted = !king && (toBit & CROWN_ROW<PL>);
+    if (undo.promoted) {
+        pos.kings |= toBit;
+        pos.key ^= pieceKey(MAN, mv.to) ^ pieceKey(KING, mv.to);
+    }
+}
+
+// Exact inverse of makeMove<PL>
+template<Player PL>
+void unmakeMove(Position& pos, const Move& mv, const Undo& undo) {
+    uint32_t fromBit = 1u << mv.from;
+    uint32_t toBit = 1u << mv.to;
+    uint32_t& own = ownPieces<PL>(pos);
+
+    own = (own & ~toBit) | fromBit;
+    if (pos.kings & toBit) {
+        pos.kings &= ~toBit;
+        if (!undo.promoted) pos.kings |= fromBit;
+    }
+
+    ownPieces<opponent(PL)>(pos) |= mv.captured;
+    pos.kings |= undo.capturedKings;
+    pos.key = undo.key;
+}
+
+template void makeMove<WHITE>(Position&, const Move&, Undo&);
+template void makeMove<BLACK>(Position&, const Move&, Undo&);
+template void unmakeMove<WHITE>(Position&, const Move&, const Undo&);
+template void unmakeMove<BLACK>(Position&, const Move&, const Undo&);
+
+// The mover is whoever stands on mv.from before the move / on mv.to after it
+void makeMove(Position& pos, const Move& mv, Undo& undo) {
+    if (pos.white & (1u << mv.from)) makeMove<WHITE>(pos, mv, undo);
+    else makeMove<BLACK>(pos, mv, undo);
+}
+
+void unmakeMove(Position& pos, const Move& mv, const Undo& undo) {
+    if (pos.white & (1u << mv.to)) unmakeMove<WHITE>(pos, mv, undo);
+    else unmakeMove<BLACK>(pos, mv, undo);
+}
@@ -0,0 +1,242 @@
+#pragma once
+/*
+  Board representation and move generation (core rules).
+  -------------------------------------------------------
+  Only the 32 dark squares can ever hold a piece, so the position is stored
+  as three 32-bit masks (one bit per dark square):
+  - white: squares holding a white piece (man or king)
+  - black: squares holding a black piece (man or king)
+  - kings: squares holding a king of either colour
+
+  Square numbering (0..31):
+    index = row * 4 + col / 2
+  Row 0 is the top row printed on screen (rank "1"); white starts on rows 0..2
+  and moves downward (+1 row), black starts on rows 5..7 and moves upward.
+*/
+
+#include <cassert>
+#include <cstdint>
+
+/*
+  We represent pieces with integers:
+  0 = empty
+  1 = white man
+  2 = white king
+  3 = black man
+  4 = black king
+*/
+enum Piece {
+    EMPTY = 0,
+    W_MAN = 1,
+    W_KING = 2,
+    B_MAN = 3,
+    B_KING = 4
+};
+
+/*
+  Player turn:
+  WHITE = Player 1
+  BLACK = Player 2
+*/
+enum Player {
+    WHITE = 1,
+    BLACK = 2
+};
+
+// The other player
+constexpr Player opponent(Player pl) {
+    return (pl == WHITE) ? BLACK : WHITE;
+}
+
+/*
+  Whole game position: three masks plus the Zobrist key of the pieces.
+  The key is kept up to date by every function below that changes the
+  position; code that fills the masks by hand must call refreshKey().
+  The side to move is not part of the position, positionKey() mixes it in.
+*/
+struct Position {
+    uint32_t white;
+    uint32_t black;
+    uint32_t kings;
+    uint64_t key;
+};
+
+/*
+  A Move structure describes one complete turn (16 bytes):
+  - from / to: square indices (0..31)
+  - jumps: number of jumps (0 for a simple move)
+  - captured: mask of all squares jumped over
+  - path: landing square of every jump, 5 bits each, first jump in the low
+    bits (landing(jumps - 1) == to). A chain can capture at most 12 pieces,
+    which fits in 60 bits.
+*/
+struct Move {
+    uint64_t path;
+    uint32_t captured;
+    uint8_t from, to;
+    uint8_t jumps;
+
+    bool isCapture() const { return jumps != 0; }
+    int landing(int i) const { return int(path >> (5 * i)) & 31; }
+};
+
+/*
+  Fixed-capacity move list living on the stack.
+  A reachable checkers position has far fewer legal moves than this
+  (usually < 20, about 50 in pathological king positions), so move
+  generation never touches the heap.
+*/
+constexpr int MAX_MOVES = 128;
+
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    void clear() { count = 0; }
+    void push(const Move& m) {
+        assert(count < MAX_MOVES);
+        moves[count++] = m;
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
+
+/*
+  16-bit fingerprint of a move (from, to and a hash of the captured squares),
+  used where a full Move is too large to store, e.g. hash table entries.
+  It only has to tell apart the moves of one position.
+*/
+inline uint16_t moveCode(const Move& m) {
+    uint32_t capHash = uint32_t((m.captured * 0x9E3779B97F4A7C15ull) >> 58);
+    return uint16_t(m.from | (m.to << 5) | (capHash << 10));
+}
+
+/* ------------------ Square helpers ------------------ */
+
+// Check if (r,c) is inside the 8x8 board
+constexpr bool inBounds(int r, int c) {
+    return r >= 0 && r < 8 && c >= 0 && c < 8;
+}
+
+// In checkers, only dark squares are used.
+// With this coordinate system (0-based), dark squares are where (r+c) is odd.
+constexpr bool isDarkSquare(int r, int c) {
+    return (r + c) % 2 == 1;
+}
+
+// (r,c) of a dark square -> square index 0..31
+constexpr int squareIndex(int r, int c) {
+    return r * 4 + c / 2;
+}
+
+// Square index -> row / column
+constexpr int sqRow(int sq) {
+    return sq >> 2;
+}
+constexpr int sqCol(int sq) {
+    return 2 * (sq & 3) + ((sq >> 2) & 1 ? 0 : 1);
+}
+
+/* ------------------ Position queries ------------------ */
+
+// Masks of the pieces of one player
+inline uint32_t piecesOf(const Position& pos, Player pl) {
+    return (pl == WHITE) ? pos.white : pos.black;
+}
+inline uint32_t emptySquares(const Position& pos) {
+    return ~(pos.white | pos.black);
+}
+
+// What stands on a square (for rendering and input checks)
+Piece pieceAt(const Position& pos, int sq);
+
+// Is the piece a king?
+bool isKing(Piece p);
+
+// Does piece p belong to player pl?
+bool belongsTo(Piece p, Player pl);
+
+/* ------------------ Hashing ------------------ */
+
+// Recompute pos.key from scratch
+void refreshKey(Position& pos);
+
+// Hash of the position with pl to move
+uint64_t positionKey(const Position& pos, Player pl);
+
+/* ------------------ Setup ------------------ */
+
+// Standard checkers start position
+void initBoard(Position& pos);
+
+/* ------------------ Move generation ------------------ */
+
+/*
+  Append the moves of the piece on sq to 'out'.
+  captureMovesFrom follows every chain of jumps to its end, so each entry is
+  a whole turn (multi-capture included).
+*/
+void captureMovesFrom(const Position& pos, int sq, Player pl, MoveList& out);
+void simpleMovesFrom(const Position& pos, int sq, Player pl, MoveList& out);
+
+// Replace the contents of 'out' with all captures / all legal moves
+void allCaptures(const Position& pos, Player pl, MoveList& out);
+void allLegalMoves(const Position& pos, Player pl, MoveList& out);
+
+// Mask of pieces of pl that have at least one capture available
+uint32_t capturers(const Position& pos, Player pl);
+
+// Mask of pieces of pl that have at least one simple move available
+uint32_t movers(const Position& pos, Player pl);
+
+/*
+  The same generators for a side known at compile time, e.g. a search that
+  alternates allLegalMoves<WHITE> and allLegalMoves<BLACK>. The functions
+  above only pick one of these. Instantiated for WHITE and BLACK in Board.cpp.
+*/
+template<Player PL> uint32_t capturers(const Position& pos);
+template<Player PL> uint32_t movers(const Position& pos);
+template<Player PL> void allCaptures(const Position& pos, MoveList& out);
+template<Player PL> void allLegalMoves(const Position& pos, MoveList& out);
+
+// Count how many pieces a player has (used for win check)
+int countPieces(const Position& pos, Player pl);
+
+/* ------------------ Applying moves ------------------ */
+
+void applyMove(Position& pos, const Move& mv);
+void maybePromote(Position& pos, int sq);
+
+/*
+  Undo record filled by makeMove, consumed by unmakeMove:
+  - capturedKings: which of the captured pieces were kings
+  - promoted: the moving man was crowned at the end of the move
+  - key: the Zobrist key before the move
+  Everything else is implied by the Move itself.
+*/
+struct Undo {
+    uint64_t key;
+    uint32_t capturedKings;
+    bool promoted;
+};
+
+/*
+  Play a whole turn in place (jumps, chain jumps and promotion) and take it
+  back again. A search walks the tree with these instead of copying the
+  position into every frame.
+*/
+void makeMove(Position& pos, const Move& mv, Undo& undo);
+void unmakeMove(Position& pos, const Move& mv, const Undo& undo);
+
+// The same for a move of PL (the generic versions look the mover up)
+template<Player PL> void makeMove(Position& pos, const Move& mv, Undo& undo);
+template<Player PL> void unmakeMove(Position& pos, const Move& mv, const Undo& undo);
@@ -0,0 +1,236 @@
+/*
+  Opening book (see Book.h).
+
+  File layout (little-endian):
+    header   "CKBK", uint32 version, uint64 entryCount
+    entries  entryCount x BookEntry, sorted by (key, move)
+*/
+
+#include "Book.h"
+#include "Notation.h"
+#include "SelfPlay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static constexpr uint32_t BOOK_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 16;
+
+bool OpeningBook::open(const char* path) {
+    entries = nullptr;
+    count = 0;
+    if (!file.open(path)) return false;
+
+    const uint8_t* base = file.data();
+    uint32_t version;
+    uint64_t n;
+    if (file.size() < HEADER_SIZE || memcmp(base, "CKBK", 4) != 0) {
+        file.close();
+        return false;
+    }
+    memcpy(&version, base + 4, 4);
+    memcpy(&n, base + 8, 8);
+    if (version != BOOK_VERSION || HEADER_SIZE + n * sizeof(BookEntry) != file.size()) {
+        file.close();
+        return false;
+    }
+    entries = (const BookEntry*)(base + HEADER_SIZE);
+    count = (size_t)n;
+    return true;
+}
+
+const BookEntry* OpeningBook::find(uint64_t key, int& n) const {
+    const BookEntry* end = entries + count;
+    const BookEntry* first = lower_bound(entries, end, key,
+        [](const BookEntry& e, uint64_t k) { return e.key < k; });
+    const BookEntry* last = first;
+    while (last != end && last->key == key) last++;
+    n = int(last - first);
+    return first;
+}
+
+static int entryGames(const BookEntry& e) {
+    return e.wins + e.draws + e.losses;
+}
+
+// Points per game of the side that played the move (draw = half a point)
+static double entryScore(const BookEntry& e) {
+    int games = entryGames(e);
+    return games ? (e.wins + 0.5 * e.draws) / games : 0.0;
+}
+
+bool OpeningBook::probe(const Position& pos, Player side, Move& out) const {
+    if (!entries) return false;
+    int n;
+    const BookEntry* e = find(positionKey(pos, side), n);
+    if (n == 0) return false;
+
+    MoveList legal;
+    allLegalMoves(pos, side, legal);
+
+    // Best score, the most played move on ties
+    const BookEntry* best = nullptr;
+    for (int i = 0; i < n; i++) {
+        if (best) {
+            double s = entryScore(e[i]), b = entryScore(*best);
+            if (s < b || (s == b && entryGames(e[i]) <= entryGames(*best))) continue;
+        }
+        for (const Move& m : legal) {
+            if (moveCode(m) != e[i].move) continue;
+            out = m;
+            best = &e[i];
+            break;
+        }
+    }
+    return best != nullptr;
+}
+
+/* ------------------ Building ------------------ */
+
+static bool sameSlot(const BookEntry& a, const BookEntry& b) {
+    return a.key == b.key && a.move == b.move;
+}
+
+static void addResult(BookEntry& e, int won) {
+    uint16_t& field = (won > 0) ? e.wins : (won < 0) ? e.losses : e.draws;
+    if (field < UINT16_MAX) field++;
+}
+
+static bool writeBook(const char* path, const vector<BookEntry>& book) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    uint8_t head[HEADER_SIZE] = { 'C', 'K', 'B', 'K' };
+    uint64_t n = book.size();
+    memcpy(head + 4, &BOOK_VERSION, 4);
+    memcpy(head + 8, &n, 8);
+    bool ok = fwrite(head, 1, HEADER_SIZE, f) == HEADER_SIZE
+        && fwrite(book.data(), sizeof(BookEntry), book.size(), f) == book.size();
+    return fclose(f) == 0 && ok;
+}
+
+/*
+  Play the games, record the first plies of each one with its result,
+  then sort and merge the records of identical (position, move) pairs.
+*/
+static int buildBook(int argc, char* argv[]) {
+    int games = 2000;
+    int bookPlies = 16;
+    int minGames = 2;
+    int jobs = max(1u, thread::hardware_concurrency());
+    const char* outPath = "checkers.book";
+
+    SelfPlayOptions opt;
+    opt.white.limits.maxDepth = opt.black.limits.maxDepth = 6;
+    opt.randomPlies = 4;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        bool ok = i + 1 < argc;
+        int val = ok ? atoi(argv[i + 1]) : 0;
+        if (arg == "--games" && ok) games = val;
+        else if (arg == "--plies" && ok) bookPlies = val;
+        else if (arg == "--depth" && ok) opt.white.limits.maxDepth = opt.black.limits.maxDepth = val;
+        else if (arg == "--random-plies" && ok) opt.randomPlies = val;
+        else if (arg == "--max-plies" && ok) opt.maxPlies = val;
+        else if (arg == "--min-games" && ok) minGames = val;
+        else if (arg == "--jobs" && ok) jobs = max(1, val);
+        else if (arg == "--out" && ok) outPath = argv[i + 1];
+        else {
+            fprintf(stderr, "book: bad option '%s'\n", arg.c_str());
+            return 1;
+        }
+        i++;
+    }
+
+    vector<vector<BookEntry>> records(jobs);
+    atomic<int> nextGame{ 0 };
+    vector<thread> pool;
+    for (int j = 0; j < jobs; j++) {
+        pool.emplace_back([&, j] {
+            SelfPlayWorker worker(16);
+            vector<Move> moves;
+            for (int g; (g = nextGame.fetch_add(1)) < games; ) {
+                GameResult r = worker.play(opt, (uint64_t)g + 1, &moves);
+
+                Position pos;
+                initBoard(pos);
+                Player side = WHITE;
+                for (int ply = 0; ply < bookPlies && ply < (int)moves.size(); ply++) {
+                    BookEntry e = { positionKey(pos, side), moveCode(moves[ply]), 0, 0, 0 };
+                    addResult(e, r.winner == 0 ? 0 : r.winner == side ? 1 : -1);
+                    records[j].push_back(e);
+
+                    Undo undo;
+                    makeMove(pos, moves[ply], undo);
+                    side = opponent(side);
+                }
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    vector<BookEntry> all;
+    for (auto& r : records) all.insert(all.end(), r.begin(), r.end());
+    sort(all.begin(), all.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    });
+
+    vector<BookEntry> book;
+    for (size_t i = 0; i < all.size(); ) {
+        BookEntry e = all[i];
+        for (i++; i < all.size() && sameSlot(all[i], e); i++) {
+            e.wins = (uint16_t)min<int>(UINT16_MAX, e.wins + all[i].wins);
+            e.draws = (uint16_t)min<int>(UINT16_MAX, e.draws + all[i].draws);
+            e.losses = (uint16_t)min<int>(UINT16_MAX, e.losses + all[i].losses);
+        }
+        if (entryGames(e) >= minGames) book.push_back(e);
+    }
+
+    if (!writeBook(outPath, book)) {
+        fprintf(stderr, "book: cannot write %s\n", outPath);
+        return 1;
+    }
+    printf("wrote %s: %zu entries from %d games\n", outPath, book.size(), games);
+    return 0;
+}
+
+static int showBook(const char* path) {
+    OpeningBook book;
+    if (!book.open(path)) {
+        fprintf(stderr, "book: cannot open %s\n", path);
+        return 1;
+    }
+    Position pos;
+    initBoard(pos);
+    MoveList legal;
+    allLegalMoves(pos, WHITE, legal);
+
+    int n;
+    const BookEntry* e = book.find(positionKey(pos, WHITE), n);
+    printf("move      games   wins  draws  losses  score\n");
+    for (int i = 0; i < n; i++) {
+        string name = "?";
+        for (const Move& m : legal)
+            if (moveCode(m) == e[i].move) name = moveName(m);
+        printf("%-8s %6d %6d %6d %7d  %.3f\n", name.c_str(), entryGames(e[i]),
+            e[i].wins, e[i].draws, e[i].losses, entryScore(e[i]));
+    }
+    return 0;
+}
+
+int bookCommand(int argc, char* argv[]) {
+    string sub = (argc > 0) ? argv[0] : "";
+    if (sub == "build") return buildBook(argc - 1, argv + 1);
+    if (sub == "show" && argc > 1) return showBook(argv[1]);
+
+    fprintf(stderr, "usage: book build [options] | book show FILE\n");
+    return 1;
+}
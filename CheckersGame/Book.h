@@ -0,0 +1,50 @@
+#pragma once
+/*
+  Opening book.
+  -------------
+  Moves for the first plies of the game, learned from self-play results:
+  - Every (position, move) pair seen in the opening of a self-play game is
+    one 16-byte entry with the wins / draws / losses of the side that
+    played it. The position is its Zobrist key with the side to move.
+  - The file is the entries sorted by key, behind a 16-byte header. It is
+    memory-mapped and binary-searched in place, nothing is loaded.
+  - The book plays the move with the best score (wins + draws / 2 per
+    game) among those played often enough.
+
+  Command line:
+    book build [--games N] [--plies N] [--depth D] [--random-plies N]
+               [--max-plies N] [--min-games N] [--jobs N] [--out FILE]
+    book show FILE                      book moves of the start position
+*/
+
+#include "Board.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+
+struct BookEntry {
+    uint64_t key;      // positionKey() of the position
+    uint16_t move;     // moveCode() of the move played
+    uint16_t wins, draws, losses;
+};
+static_assert(sizeof(BookEntry) == 16, "book entries are 16 bytes on disk");
+
+class OpeningBook {
+public:
+    // Map a file written by "book build"; false if missing or malformed
+    bool open(const char* path);
+    bool isOpen() const { return file.isOpen(); }
+
+    // Book move for the position, false if it is not in the book
+    bool probe(const Position& pos, Player side, Move& out) const;
+
+    // All entries of one position (count 0 if none)
+    const BookEntry* find(uint64_t key, int& count) const;
+
+private:
+    MappedFile file;
+    const BookEntry* entries = nullptr;
+    size_t count = 0;
+};
+
+int bookCommand(int argc, char* argv[]);
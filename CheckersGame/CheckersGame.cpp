@@ -13,6 +13,40 @@
   Input:
   - From-to format like:  b6 a5
   - During multi-capture, only enter next destination square like: c3
+  - One move per line; the game ends (unfinished) when the input does
+
+  Command line:
+  - --ai white|black|both   let the computer play that side
+  - --movetime <ms>         computer thinking time per move (default 1000)
+  - --depth <n>             computer search depth limit
+  - --hash <mb>             transposition table size in MB (default 64)
+  - --threads <n>           computer search threads (default 1)
+  - --diff                  redraw only the squares that changed
+  - --tb <file>             endgame tablebase written by tbgen
+  - --book <file>           opening book written by "book build"
+  - --eval <file>           evaluation weights (see "tune")
+  - --fen "<fen>"           start from this position (e.g. "W:WK10,K12:B3")
+  - --load <file>           continue the first game of a PDN file
+  - --save <file>           write the game as PDN when it ends
+  - --idle-timeout <s>      end the game if no move is entered for that long
+  - --no-ponder             do not think on the human's time (see Ponder.h)
+
+  Other modes (first argument):
+  - perft <depth> [position|FEN]           move generator counts and speed
+  - perft divide <depth> [position|FEN]    count below every root move
+  - perft test [maxDepth]                  check the built-in known counts
+  - perft list                             names of the built-in positions
+  - selfplay [options]                     headless engine/random matches
+  - smpbench [maxThreads] [movetimeMs]     search speed vs. thread count
+  - tbgen [--pieces N] [--out FILE]        generate an endgame tablebase
+  - book build [options] | book show FILE  opening book from self-play
+  - pdn check FILE...                      replay and validate PDN archives
+  - records pdn IN OUT | records info FILE binary positions for training
+  - analyse FILE [options]                 search or perft a file of FEN positions
+  - tune RECORDS... [options]              fit the evaluation weights to game results
+  - engine [options]                       text protocol for GUIs and match managers
+  - server [options]                       host many games over TCP
+  - tournament --engine SPEC ...           engine matches with Elo and SPRT
 */
 
 
@@ -20,486 +54,386 @@
 #include <Windows.h>
 #endif
 
+#include "Analyse.h"
+#include "Board.h"
+#include "Book.h"
+#include "Engine.h"
+#include "Eval.h"
+#include "Game.h"
+#include "Input.h"
+#include "Notation.h"
+#include "ParallelSearch.h"
+#include "Pdn.h"
+#include "Perft.h"
+#include "Ponder.h"
+#include "Records.h"
+#include "Render.h"
+#include "SelfPlay.h"
+#include "Server.h"
+#include "Tablebase.h"
+#include "Tournament.h"
+
 #include <iostream>
-#include <vector>
 #include <string>
-#include <cctype>
 #include <algorithm>
-#include <cstdlib>   // for system()
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
 
 using namespace std;
 
-/*
-  We represent pieces with integers:
-  0 = empty
-  1 = white man
-  2 = white king
-  3 = black man
-  4 = black king
-*/
-enum Piece {
-    EMPTY = 0,
-    W_MAN = 1,
-    W_KING = 2,
-    B_MAN = 3,
-    B_KING = 4
-};
-
-/*
-  Player turn:
-  WHITE = Player 1
-  BLACK = Player 2
-*/
-enum Player {
-    WHITE = 1,
-    BLACK = 2
-};
-
-/*
-  A Move structure describes one move:
-  - from (fr, fc) to (tr, tc)
-  - isCapture: whether it jumps over an enemy
-  - (cr, cc): the captured enemy location (only valid if isCapture == true)
-*/
-struct Move {
-    int fr, fc;
-    int tr, tc;
-    bool isCapture;
-    int cr, cc;
-};
-
-// 8x8 board
-static int board[8][8];
-
 /* ------------------ Utility helpers ------------------ */
 
-// Check if (r,c) is inside the 8x8 board
-static bool inBounds(int r, int c) {
-    return r >= 0 && r < 8 && c >= 0 && c < 8;
+// Piece standing on (r,c); light squares are always empty
+static Piece pieceOn(const Position& pos, int r, int c) {
+    if (!isDarkSquare(r, c)) return EMPTY;
+    return pieceAt(pos, squareIndex(r, c));
 }
 
-// In checkers, only dark squares are used.
-// With this coordinate system (0-based), dark squares are where (r+c) is odd.
-static bool isDarkSquare(int r, int c) {
-    return (r + c) % 2 == 1;
-}
-
-// Is the piece a king?
-static bool isKing(Piece p) {
-    return p == W_KING || p == B_KING;
-}
-
-// Does piece p belong to player pl?
-static bool belongsTo(Piece p, Player pl) {
-    if (p == EMPTY) return false;
-    if (pl == WHITE) return p == W_MAN || p == W_KING;
-    return p == B_MAN || p == B_KING;
+// Compare the first step of a generated Move with user input (from->to)
+static bool sameMove(const Move& a, int fr, int fc, int tr, int tc) {
+    int firstTo = a.isCapture() ? a.landing(0) : a.to;
+    return a.from == squareIndex(fr, fc) && firstTo == squareIndex(tr, tc);
 }
 
-// Are two pieces enemies? (white vs black)
-static bool isEnemy(Piece a, Piece b) {
-    if (a == EMPTY || b == EMPTY) return false;
-    bool aWhite = (a == W_MAN || a == W_KING);
-    bool bWhite = (b == W_MAN || b == W_KING);
-    return aWhite != bWhite;
+// Play a single jump prev -> next (used to show a chain while it is entered)
+static void showJump(Position& pos, int prev, int next) {
+    int mid = squareIndex((sqRow(prev) + sqRow(next)) / 2, (sqCol(prev) + sqCol(next)) / 2);
+    Move hop = { 0, 1u << mid, (uint8_t)prev, (uint8_t)next, 1 };
+    applyMove(pos, hop);
 }
 
-// Printable symbols for each piece (feel free to change)
-static string pieceStr(Piece p) {
-    switch (p) {
-    case EMPTY:  return "    ";
-    case W_MAN:  return " WB ";
-    case W_KING: return " WK ";
-    case B_MAN:  return " BM ";
-    case B_KING: return " BK ";
-    default:     return " ? ";
-    }
-}
+/* ------------------ Main game loop ------------------ */
 
-// Clear console screen (Windows vs Linux/macOS)
-static void clearScreen() {
-#if __linux__
-    system("clear");
-#else
-    system("cls");
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
 #endif
-}
 
-/* ------------------ Board setup & rendering ------------------ */
-
-// Initialize board to standard checkers start position
-static void initBoard() {
-    // 1) clear everything
-    for (int r = 0; r < 8; r++)
-        for (int c = 0; c < 8; c++)
-            board[r][c] = EMPTY;
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
 
-    // 2) place white men on rows 0..2 on dark squares
-    for (int r = 0; r < 3; r++) {
-        for (int c = 0; c < 8; c++) {
-            if (isDarkSquare(r, c)) board[r][c] = W_MAN;
-        }
+    if (argc > 1) {
+        string mode = argv[1];
+        if (mode == "perft") return perftCommand(argc - 2, argv + 2);
+        if (mode == "selfplay") return selfPlayCommand(argc - 2, argv + 2);
+        if (mode == "tournament") return tournamentCommand(argc - 2, argv + 2);
+        if (mode == "smpbench") return smpBenchCommand(argc - 2, argv + 2);
+        if (mode == "tbgen") return tbGenCommand(argc - 2, argv + 2);
+        if (mode == "book") return bookCommand(argc - 2, argv + 2);
+        if (mode == "pdn") return pdnCommand(argc - 2, argv + 2);
+        if (mode == "records") return recordsCommand(argc - 2, argv + 2);
+        if (mode == "analyse") return analyseCommand(argc - 2, argv + 2);
+        if (mode == "tune") return tuneCommand(argc - 2, argv + 2);
+        if (mode == "engine") return engineCommand(argc - 2, argv + 2);
+        if (mode == "server") return serverCommand(argc - 2, argv + 2);
     }
 
-    // 3) place black men on rows 5..7 on dark squares
-    for (int r = 5; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            if (isDarkSquare(r, c)) board[r][c] = B_MAN;
+    // Which sides the computer plays (indexed by Player)
+    bool aiPlays[3] = { false, false, false };
+    SearchLimits limits;
+    limits.moveTimeMs = 1000;
+    size_t hashMb = 64;
+    int threads = 1;
+    ConsoleRenderer renderer;
+    Tablebase tablebase;
+    OpeningBook book;
+    string loadPath, savePath;
+    int idleTimeoutMs = -1;
+    bool ponderOn = true;
+    Position start;
+    Player startSide = WHITE;
+    initBoard(start);
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string val = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--ai" && !val.empty()) {
+            if (val == "white" || val == "both") aiPlays[WHITE] = true;
+            if (val == "black" || val == "both") aiPlays[BLACK] = true;
+            i++;
         }
-    }
-}
-
-// Print the board with coordinates like chess: columns a-h and rows 1-8
-static void printBoard() {
-    cout << "  +----+----+----+----+----+----+----+----+\n";
-    for (int r = 0; r < 8; r++) {
-        cout << (r + 1) << " |";
-        for (int c = 0; c < 8; c++) {
-            cout << pieceStr((Piece)board[r][c]) << "|";
+        else if (arg == "--movetime" && !val.empty()) {
+            limits.moveTimeMs = atoi(val.c_str());
+            i++;
         }
-        cout << "\n  +----+----+----+----+----+----+----+----+\n";
-    }
-    cout << "    a    b    c    d    e    f    g    h\n";
-}
-
-// Convert (r,c) -> "b6" for user friendly printing
-static string sqToStr(int r, int c) {
-    string s;
-    s += char('a' + c);
-    s += char('1' + r);
-    return s;
-}
-
-/*
-  Parse a square from input token.
-  Example tokens: "b6", "B6", "b6," etc.
-  We search for:
-  - first letter a-h => file (column)
-  - first digit 1-8  => rank (row)
-*/
-static bool parseSquare(const string& token, int& r, int& c) {
-    if (token.size() < 2) return false;
-
-    char file = 0;
-    char rank = 0;
-
-    for (char ch : token) {
-        if (isalpha((unsigned char)ch)) { file = (char)tolower(ch); break; }
-    }
-    for (char ch : token) {
-        if (isdigit((unsigned char)ch)) { rank = ch; break; }
-    }
-
-    if (file < 'a' || file > 'h') return false;
-    if (rank < '1' || rank > '8') return false;
-
-    c = file - 'a';
-    r = rank - '1';
-    return inBounds(r, c);
-}
-
-/*
-  Forward direction:
-  - White moves downward => +1 row
-  - Black moves upward   => -1 row
-*/
-static int forwardDir(Player pl) {
-    return (pl == WHITE) ? +1 : -1;
-}
-
-/* ------------------ Move generation (core rules) ------------------ */
-
-/*
-  Generate all capture moves FROM a single piece at (r,c).
-  For men:
-    - can capture only forward diagonals (2 steps)
-  For kings:
-    - can capture in all 4 diagonals (2 steps)
-*/
-static vector<Move> captureMovesFrom(int r, int c, Player pl) {
-    vector<Move> moves;
-
-    Piece p = (Piece)board[r][c];
-    if (!belongsTo(p, pl)) return moves;
-
-    // direction deltas for diagonal movement
-    vector<pair<int, int>> dirs;
-    if (isKing(p)) {
-        dirs = { {+1,+1},{+1,-1},{-1,+1},{-1,-1} };
-    }
-    else {
-        int d = forwardDir(pl);
-        dirs = { {d,+1},{d,-1} };
-    }
-
-    // A capture checks:
-    //   adjacent square contains enemy
-    //   landing square (2 steps away) is empty
-    for (auto [dr, dc] : dirs) {
-        int r1 = r + dr, c1 = c + dc;       // enemy position
-        int r2 = r + 2 * dr, c2 = c + 2 * dc;     // landing position
-
-        if (!inBounds(r1, c1) || !inBounds(r2, c2)) continue;
-        if (board[r2][c2] != EMPTY) continue;
-
-        if (isEnemy(p, (Piece)board[r1][c1])) {
-            moves.push_back({ r,c,r2,c2,true,r1,c1 });
+        else if (arg == "--depth" && !val.empty()) {
+            limits.maxDepth = atoi(val.c_str());
+            i++;
         }
-    }
-
-    return moves;
-}
-
-/*
-  Generate all simple (non-capture) moves FROM a single piece at (r,c).
-  For men:
-    - 1 step forward diagonals
-  For kings:
-    - 1 step in any diagonal direction
-*/
-static vector<Move> simpleMovesFrom(int r, int c, Player pl) {
-    vector<Move> moves;
-
-    Piece p = (Piece)board[r][c];
-    if (!belongsTo(p, pl)) return moves;
-
-    vector<pair<int, int>> dirs;
-    if (isKing(p)) {
-        dirs = { {+1,+1},{+1,-1},{-1,+1},{-1,-1} };
-    }
-    else {
-        int d = forwardDir(pl);
-        dirs = { {d,+1},{d,-1} };
-    }
-
-    for (auto [dr, dc] : dirs) {
-        int r2 = r + dr, c2 = c + dc;
-        if (!inBounds(r2, c2)) continue;
-        if (board[r2][c2] != EMPTY) continue;
-        moves.push_back({ r,c,r2,c2,false,-1,-1 });
-    }
-
-    return moves;
-}
-
-/*
-  Collect ALL capture moves available for a player on the whole board.
-  This is important because capturing is mandatory:
-  if any capture exists, player must choose a capture move.
-*/
-static vector<Move> allCaptures(Player pl) {
-    vector<Move> res;
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            auto m = captureMovesFrom(r, c, pl);
-            res.insert(res.end(), m.begin(), m.end());
+        else if (arg == "--hash" && !val.empty()) {
+            hashMb = (size_t)atoi(val.c_str());
+            i++;
         }
-    }
-    return res;
-}
-
-/*
-  Collect ALL legal moves for the player:
-  - If captures exist => only capture moves are legal (mandatory capture rule)
-  - Otherwise => all simple moves are legal
-*/
-static vector<Move> allLegalMoves(Player pl) {
-    auto caps = allCaptures(pl);
-    if (!caps.empty()) return caps;
-
-    vector<Move> res;
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            auto m = simpleMovesFrom(r, c, pl);
-            res.insert(res.end(), m.begin(), m.end());
+        else if (arg == "--threads" && !val.empty()) {
+            threads = atoi(val.c_str());
+            i++;
+        }
+        else if (arg == "--tb" && !val.empty()) {
+            if (!tablebase.open(val.c_str())) {
+                cout << "Cannot open tablebase: " << val << "\n";
+                return 1;
+            }
+            i++;
+        }
+        else if (arg == "--book" && !val.empty()) {
+            if (!book.open(val.c_str())) {
+                cout << "Cannot open opening book: " << val << "\n";
+                return 1;
+            }
+            i++;
+        }
+        else if (arg == "--eval" && !val.empty()) {
+            if (!loadEvalWeights(val.c_str())) return 1;
+            i++;
+        }
+        else if (arg == "--fen" && !val.empty()) {
+            if (!parseFen(val, start, startSide)) {
+                cout << "Bad FEN: " << val << "\n";
+                return 1;
+            }
+            i++;
+        }
+        else if (arg == "--load" && !val.empty()) {
+            loadPath = val;
+            i++;
+        }
+        else if (arg == "--save" && !val.empty()) {
+            savePath = val;
+            i++;
+        }
+        else if (arg == "--idle-timeout" && !val.empty()) {
+            idleTimeoutMs = atoi(val.c_str()) * 1000;
+            i++;
+        }
+        else if (arg == "--no-ponder") {
+            ponderOn = false;
+        }
+        else if (arg == "--diff") {
+            renderer.setDiffMode(true);
+        }
+        else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
         }
     }
-    return res;
-}
-
-// Count how many pieces a player has (used for win check)
-static int countPieces(Player pl) {
-    int cnt = 0;
-    for (int r = 0; r < 8; r++)
-        for (int c = 0; c < 8; c++)
-            if (belongsTo((Piece)board[r][c], pl))
-                cnt++;
-    return cnt;
-}
-
-// Compare a generated Move with user input (from->to)
-static bool sameMove(const Move& a, int fr, int fc, int tr, int tc) {
-    return a.fr == fr && a.fc == fc && a.tr == tr && a.tc == tc;
-}
-
-/*
-  Apply a move to the board:
-  - Move piece from (fr,fc) to (tr,tc)
-  - Clear old position
-  - If capture => remove captured enemy at (cr,cc)
-*/
-static void applyMove(const Move& mv) {
-    Piece p = (Piece)board[mv.fr][mv.fc];
-    board[mv.tr][mv.tc] = p;
-    board[mv.fr][mv.fc] = EMPTY;
 
-    if (mv.isCapture) {
-        board[mv.cr][mv.cc] = EMPTY;
+    Game game;
+    game.reset(start, startSide);
+
+    if (!loadPath.empty()) {
+        FILE* in = fopen(loadPath.c_str(), "rb");
+        PdnReader reader(in);
+        PdnGame record;
+        if (!in || !reader.next(record) || !record.error.empty()) {
+            cout << "Cannot load " << loadPath << (record.error.empty() ? "" : ": " + record.error) << "\n";
+            if (in) fclose(in);
+            return 1;
+        }
+        fclose(in);
+        game.reset(record.start, record.startSide);
+        for (const Move& m : record.moves) game.play(m);
     }
-}
 
-/*
-  Promotion rule:
-  - White man becomes king when it reaches row 7
-  - Black man becomes king when it reaches row 0
-  Note: we promote at end of turn (after chain captures).
-*/
-static void maybePromote(int r, int c) {
-    Piece p = (Piece)board[r][c];
-    if (p == W_MAN && r == 7) board[r][c] = W_KING;
-    if (p == B_MAN && r == 0) board[r][c] = B_KING;
-}
+    TransTable tt(hashMb);
+    ParallelSearch ai(tt, threads);
+    if (tablebase.isOpen()) ai.setTablebase(&tablebase);
+    Ponderer ponder(ai, tt);
+    string lastMove;
+    string notice;   // error from the previous input, shown in the next frame
+    LineReader input;   // stdin
+    string_view line;
+    const char* quitReason = nullptr;   // set when the input ends the game
 
-/* ------------------ Main game loop ------------------ */
+    while (!quitReason) {
+        const Position& board = game.position();
+        Player turn = game.turn();
 
-int main() {
-#ifdef _WIN32
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-#endif
-
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
-
-    initBoard();
-
-    Player turn = WHITE;
-
-    while (true) {
-        // Win condition 1: player has no pieces left
-        if (countPieces(WHITE) == 0) {
-            cout << "GAME OVER! BLACK wins (WHITE has no pieces).\n";
-            break;
-        }
-        if (countPieces(BLACK) == 0) {
-            cout << "GAME OVER! WHITE wins (BLACK has no pieces).\n";
+        /*
+          The side to move loses when it has no pieces left (win condition 1)
+          or no legal move (win condition 2). A threefold repetition or 40
+          moves each without a capture or a man move is a draw.
+        */
+        if (game.over()) {
+            string loser = (turn == WHITE) ? "WHITE" : "BLACK";
+            string won = (turn == WHITE) ? "BLACK" : "WHITE";
+            if (game.status() == GAME_NO_PIECES)
+                renderer.draw(board, "\nGAME OVER! " + won + " wins (" + loser + " has no pieces).\n");
+            else if (game.status() == GAME_NO_MOVES)
+                renderer.draw(board, "\nGAME OVER! " + won + " wins (opponent has no legal moves).\n");
+            else if (game.status() == GAME_REPETITION)
+                renderer.draw(board, "\nGAME OVER! Draw (the same position occurred three times).\n");
+            else
+                renderer.draw(board, "\nGAME OVER! Draw (40 moves each without a capture or a man move).\n");
             break;
         }
+        const MoveList& legal = game.legalMoves();
+
+        // Everything below the board is collected here and drawn in one go
+        string status;
+        if (!lastMove.empty()) status += "\nLast move: " + lastMove + "\n";
+        status += string("\nTurn: ") + (turn == WHITE ? "WHITE (Player 1)" : "BLACK (Player 2)") + "\n";
+
+        // Computer to move
+        if (aiPlays[turn]) {
+            renderer.draw(board, status + "Computer is thinking...\n");
+            Move mv;
+            if (book.probe(board, turn, mv)) {
+                lastMove = moveName(mv) + " (computer, book)";
+            }
+            else {
+                SearchResult sr = ponder.search(game, limits);
+                mv = sr.best;
+                lastMove = moveName(mv) + " (computer, depth " + to_string(sr.depth)
+                    + ", score " + to_string(sr.score) + (ponder.lastWasHit() ? ", ponder hit" : "") + ")";
+            }
 
-        // Determine legal moves for current player
-        auto legal = allLegalMoves(turn);
-
-        // Win condition 2: player has no legal moves => loses
-        if (legal.empty()) {
-            cout << "GAME OVER! " << (turn == WHITE ? "BLACK" : "WHITE")
-                << " wins (opponent has no legal moves).\n";
-            break;
+            game.play(mv);
+            continue;
         }
+        if (game.mustCapture())
+            status += "Rule: Capture is available => you MUST capture.\n";
+        if (!notice.empty()) status += notice + "\n";
+        status += "Enter move like: b6 a5 (from to)\n> ";
 
-        clearScreen();
-        printBoard();
-
-        cout << "\nTurn: " << (turn == WHITE ? "WHITE (Player 1)" : "BLACK (Player 2)") << "\n";
-        if (!allCaptures(turn).empty())
-            cout << "Rule: Capture is available => you MUST capture.\n";
+        renderer.draw(board, status);
+        notice.clear();
 
-        cout << "Enter move like: b6 a5 (from to)\n> ";
+        // The computer thinks on through invalid input and chain landings until the move is played
+        if (ponderOn && aiPlays[opponent(turn)]) ponder.start(game, limits);
 
-        // Read two tokens from user (from-square and to-square)
-        string t1, t2;
-        if (!(cin >> t1 >> t2)) break;
+        // One line with two squares (from-square and to-square)
+        ReadStatus rs = input.readLine(line, idleTimeoutMs);
+        if (rs != READ_OK) {
+            quitReason = (rs == READ_EOF) ? "end of input" : "no move entered in time";
+            break;
+        }
 
         int fr, fc, tr, tc;
-        if (!parseSquare(t1, fr, fc) || !parseSquare(t2, tr, tc)) {
-            cout << "Invalid input format. Use like b6 a5\n";
-            cin.clear();
+        string_view rest = line;
+        if (!parseSquare(nextWord(rest), fr, fc) || !parseSquare(nextWord(rest), tr, tc)) {
+            notice = "Invalid input format. Use like b6 a5";
             continue;
         }
 
         // Destination must be dark square
         if (!isDarkSquare(tr, tc)) {
-            cout << "You can only move to dark squares.\n";
+            notice = "You can only move to dark squares.";
             continue;
         }
 
         // Must move your own piece
-        Piece p = (Piece)board[fr][fc];
+        Piece p = pieceOn(board, fr, fc);
         if (!belongsTo(p, turn)) {
-            cout << "That piece is not yours.\n";
+            notice = "That piece is not yours.";
             continue;
         }
 
         // Destination must be empty
-        if (board[tr][tc] != EMPTY) {
-            cout << "Destination is not empty.\n";
+        if (pieceOn(board, tr, tc) != EMPTY) {
+            notice = "Destination is not empty.";
             continue;
         }
 
-        // Find if user move matches one of currently legal moves
-        auto it = find_if(legal.begin(), legal.end(), [&](const Move& m) {
-            return sameMove(m, fr, fc, tr, tc);
-            });
+        // Keep every legal move that starts with the entered step
+        MoveList cands;
+        for (auto& m : legal)
+            if (sameMove(m, fr, fc, tr, tc)) cands.push(m);
 
-        if (it == legal.end()) {
-            cout << "Illegal move.\n";
+        if (cands.empty()) {
+            notice = "Illegal move.";
             continue;
         }
 
-        // Apply the selected move
-        Move mv = *it;
-        applyMove(mv);
-
-        // Track current piece position after the move (for multi-capture)
-        int curR = mv.tr, curC = mv.tc;
-
         /*
           Multi-capture rule:
           If the move was a capture, and from the new position another capture is possible,
           the player must continue capturing with the SAME piece.
+          The generator already returns whole chains, so we only ask which branch to
+          follow until a single complete move is left.
         */
-        if (mv.isCapture) {
-            while (true) {
-                auto nextCaps = captureMovesFrom(curR, curC, turn);
-                if (nextCaps.empty()) break;
-
-                clearScreen();
-                printBoard();
-
-                cout << "\nMulti-capture required from " << sqToStr(curR, curC) << "\n";
-                cout << "Possible next landings: ";
-                for (auto& nm : nextCaps) cout << sqToStr(nm.tr, nm.tc) << " ";
-                cout << "\nEnter next destination (e.g. c3):\n> ";
-
-                string tnext;
-                cin >> tnext;
-
-                int nr, nc;
-                if (!parseSquare(tnext, nr, nc)) {
-                    cout << "Bad square input.\n";
-                    continue;
-                }
-
-                // Must choose one of the forced capture landing squares
-                auto it2 = find_if(nextCaps.begin(), nextCaps.end(), [&](const Move& m) {
-                    return m.tr == nr && m.tc == nc;
-                    });
-
-                if (it2 == nextCaps.end()) {
-                    cout << "You must continue capturing (choose one of the shown squares).\n";
-                    continue;
-                }
-
-                applyMove(*it2);
-                curR = it2->tr;
-                curC = it2->tc;
+        Position shown = board;
+        int hops = 1;
+        if (cands[0].isCapture()) showJump(shown, cands[0].from, cands[0].landing(0));
+
+        while (cands[0].jumps > hops) {
+            int cur = cands[0].landing(hops - 1);
+
+            status = "\nMulti-capture required from " + squareName(cur) + "\n";
+            status += "Possible next landings: ";
+            uint32_t listed = 0;
+            for (auto& nm : cands) {
+                int nx = nm.landing(hops);
+                if (listed & (1u << nx)) continue;
+                listed |= 1u << nx;
+                status += squareName(nx) + " ";
+            }
+            status += "\n";
+            if (!notice.empty()) status += notice + "\n";
+            status += "Enter next destination (e.g. c3):\n> ";
+
+            renderer.draw(shown, status);
+            notice.clear();
+
+            ReadStatus rs = input.readLine(line, idleTimeoutMs);
+            if (rs != READ_OK) {
+                quitReason = (rs == READ_EOF) ? "end of input" : "no move entered in time";
+                break;
+            }
+
+            int nr, nc;
+            string_view rest = line;
+            if (!parseSquare(nextWord(rest), nr, nc)) {
+                notice = "Bad square input.";
+                continue;
+            }
+
+            // Must choose one of the forced capture landing squares
+            int next = squareIndex(nr, nc);
+            if (!isDarkSquare(nr, nc) || !(listed & (1u << next))) {
+                notice = "You must continue capturing (choose one of the shown squares).";
+                continue;
             }
+
+            MoveList narrowed;
+            for (auto& nm : cands)
+                if (nm.landing(hops) == next) narrowed.push(nm);
+            cands = narrowed;
+
+            showJump(shown, cur, next);
+            hops++;
         }
+        if (quitReason) break;
+
+        // Apply the selected move (the whole chain at once, promotion at the end)
+        Move mv = cands[0];
+        lastMove = moveName(mv);
+        ponder.played(mv);
+        game.play(mv);
+    }
 
-        // Promotion happens at the end of the entire turn (after chain jumps)
-        maybePromote(curR, curC);
+    ponder.stop();
+    if (quitReason) cout << "\nGame left unfinished (" << quitReason << ").\n";
 
-        // Switch turns
-        turn = (turn == WHITE) ? BLACK : WHITE;
+    // Game record ("*" if the game was left unfinished)
+    if (!savePath.empty()) {
+        FILE* out = fopen(savePath.c_str(), "wb");
+        if (!out) {
+            cout << "Cannot write " << savePath << "\n";
+            return 1;
+        }
+        PdnGame record;
+        record.start = game.startPosition();
+        record.startSide = game.startSide();
+        record.moves = game.moves();
+        record.result = game.over() ? pdnResult(game.winner()) : "*";
+        record.tags = { { "Event", "CheckersGame" },
+                        { "Black", aiPlays[WHITE] ? "computer" : "human" },   // PDN Black moves first
+                        { "White", aiPlays[BLACK] ? "computer" : "human" },
+                        { "Result", record.result } };
+        writePdnGame(out, record);
+        fclose(out);
     }
 
     return 0;
@@ -0,0 +1,256 @@
+/*
+  Engine protocol (see Engine.h).
+*/
+
+#include "Engine.h"
+#include "Book.h"
+#include "Eval.h"
+#include "Input.h"
+#include "Notation.h"
+#include "ParallelSearch.h"
+#include "Perft.h"
+#include "Stats.h"
+#include "Tablebase.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// The search thread replies too: one line at a time, flushed for pipes
+static mutex outMutex;
+
+static void reply(const string& line) {
+    lock_guard<mutex> lock(outMutex);
+    fputs(line.c_str(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
+
+struct EngineState {
+    Position pos;
+    Player side = WHITE;
+    PositionHistory positions;   // since the setup of the last "position" command
+    int defaultMoveTimeMs = 1000;
+    const OpeningBook* book = nullptr;
+    atomic<bool> searching{ false };
+};
+
+static bool parseNumber(string_view word, int& out) {
+    if (word.empty() || word.size() > 9) return false;
+    int v = 0;
+    for (char ch : word) {
+        if (ch < '0' || ch > '9') return false;
+        v = v * 10 + (ch - '0');
+    }
+    out = v;
+    return true;
+}
+
+// "startpos [moves ...]" or "fen FEN [moves ...]"; the state is only changed on success
+static string setPosition(string_view rest, EngineState& st) {
+    Position pos;
+    Player side = WHITE;
+
+    size_t movesAt = rest.find(" moves");
+    while (movesAt != string_view::npos && movesAt + 6 < rest.size() && rest[movesAt + 6] != ' ')
+        movesAt = rest.find(" moves", movesAt + 1);
+    string_view setup = rest.substr(0, movesAt);
+    string_view moves = (movesAt == string_view::npos) ? string_view() : rest.substr(movesAt + 6);
+
+    string_view kind = nextWord(setup);
+    if (kind == "startpos") {
+        initBoard(pos);
+    }
+    else if (kind == "fen") {
+        if (!parseFen(string(setup), pos, side)) return "bad FEN";
+    }
+    else {
+        return "position needs startpos or fen";
+    }
+
+    PositionHistory positions;
+    positions.reset(positionKey(pos, side));
+
+    for (string_view word = nextWord(moves); !word.empty(); word = nextWord(moves)) {
+        Move m;
+        MoveParse res = parsePdnMove(string(word), pos, side, m);
+        if (res != MOVE_OK) {
+            const char* why = (res == MOVE_BAD) ? "bad" : (res == MOVE_ILLEGAL) ? "illegal" : "ambiguous";
+            return string(why) + " move '" + string(word) + "'";
+        }
+        bool progress = isProgress(pos, m);
+        Undo undo;
+        makeMove(pos, m, undo);
+        side = opponent(side);
+        positions.push(positionKey(pos, side), progress);
+    }
+
+    st.pos = pos;
+    st.side = side;
+    st.positions = positions;
+    return "";
+}
+
+static string go(string_view rest, EngineState& st, ParallelSearch& ai) {
+    SearchLimits limits;
+    bool limited = false;
+    for (string_view word = nextWord(rest); !word.empty(); word = nextWord(rest)) {
+        if (word == "infinite") {
+            limits.moveTimeMs = 0;
+            limited = true;
+        }
+        else if (word == "movetime" && parseNumber(nextWord(rest), limits.moveTimeMs)) {
+            limited = true;
+        }
+        else if (word == "depth" && parseNumber(nextWord(rest), limits.maxDepth) && limits.maxDepth > 0) {
+            limited = true;
+        }
+        else {
+            return "bad go argument '" + string(word) + "'";
+        }
+    }
+    if (!limited) limits.moveTimeMs = st.defaultMoveTimeMs;
+    if (limits.maxDepth > MAX_PLY - 1) limits.maxDepth = MAX_PLY - 1;
+
+    Move mv;
+    if (st.book && st.book->probe(st.pos, st.side, mv)) {
+        reply("bestmove " + pdnMoveName(mv) + " book");
+        return "";
+    }
+
+    SearchHistory recent;
+    st.positions.searchHistory(recent);
+    st.searching.store(true);
+    ai.start(st.pos, st.side, limits, &recent, [&st](const SearchResult& sr) {
+        if (!sr.hasMove) reply("bestmove none");
+        else reply("bestmove " + pdnMoveName(sr.best) + " score " + to_string(sr.score)
+            + " depth " + to_string(sr.depth) + " nodes " + to_string(sr.nodes)
+            + " time " + to_string(sr.timeMs));
+        st.searching.store(false);
+    });
+    return "";
+}
+
+int engineCommand(int argc, char* argv[]) {
+    size_t hashMb = 64;
+    int threads = 1;
+    Tablebase tablebase;
+    OpeningBook book;
+    EngineState st;
+    initBoard(st.pos);
+    st.positions.reset(positionKey(st.pos, st.side));
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--hash" && val) hashMb = (size_t)atoi(argv[++i]);
+        else if (arg == "--threads" && val) threads = atoi(argv[++i]);
+        else if (arg == "--movetime" && val) st.defaultMoveTimeMs = atoi(argv[++i]);
+        else if (arg == "--tb" && val) {
+            if (!tablebase.open(argv[++i])) {
+                fprintf(stderr, "engine: cannot open tablebase %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--eval" && val) {
+            if (!loadEvalWeights(argv[++i])) return 1;
+        }
+        else if (arg == "--book" && val) {
+            if (!book.open(argv[++i])) {
+                fprintf(stderr, "engine: cannot open opening book %s\n", argv[i]);
+                return 1;
+            }
+            st.book = &book;
+        }
+        else {
+            fprintf(stderr, "usage: engine [--hash MB] [--threads N] [--movetime MS] [--tb FILE] [--book FILE] [--eval FILE]\n");
+            return 1;
+        }
+    }
+
+    TransTable tt(hashMb);
+    ParallelSearch ai(tt, threads);
+    if (tablebase.isOpen()) ai.setTablebase(&tablebase);
+
+    LineReader input;
+    string_view line;
+    while (input.readLine(line) == READ_OK) {
+        string_view rest = line;
+        string_view cmd = nextWord(rest);
+        if (cmd.empty()) continue;
+
+        if (cmd == "quit") break;
+        if (cmd == "isready") {
+            reply("readyok");
+            continue;
+        }
+        if (cmd == "stop") {
+            // The search thread sends the bestmove before wait() returns
+            ai.stop();
+            ai.wait();
+            continue;
+        }
+        if (cmd == "stats") {
+            StatsFormat format = STATS_JSON;
+            string_view name = nextWord(rest);
+            if (!name.empty() && !parseStatsFormat(string(name), format)) reply("error unknown stats format");
+            else reply(format == STATS_JSON ? "stats " + statsText(format) : statsText(format));
+            continue;
+        }
+        if (st.searching.load()) {
+            reply("error busy");
+            continue;
+        }
+        ai.wait();   // the finished search thread may not have been joined yet
+
+        string error;
+        if (cmd == "position") {
+            error = setPosition(rest, st);
+        }
+        else if (cmd == "go") {
+            error = go(rest, st, ai);
+        }
+        else if (cmd == "fen") {
+            reply("fen " + positionFen(st.pos, st.side));
+        }
+        else if (cmd == "newgame") {
+            tt.clear();
+        }
+        else if (cmd == "perft") {
+            int depth;
+            if (!parseNumber(nextWord(rest), depth) || depth < 1 || depth > 20) {
+                error = "perft needs a depth 1-20";
+            }
+            else {
+                auto start = chrono::steady_clock::now();
+                Position pos = st.pos;
+                uint64_t n = perft(pos, st.side, depth);
+                auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+                reply("perft " + to_string(depth) + " " + to_string(n) + " time " + to_string(ms));
+            }
+        }
+        else if (cmd == "option") {
+            string_view name = nextWord(rest);
+            int v;
+            if (!parseNumber(nextWord(rest), v) || v < 1) error = "option needs a positive value";
+            else if (name == "hash") tt.resize((size_t)v);
+            else if (name == "threads") ai.setThreads(v);
+            else error = "unknown option '" + string(name) + "'";
+        }
+        else {
+            error = "unknown command '" + string(cmd) + "'";
+        }
+        if (!error.empty()) reply("error " + error);
+    }
+
+    // End of input or quit: finish the search and its bestmove first
+    ai.stop();
+    ai.wait();
+    return 0;
+}
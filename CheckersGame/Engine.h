@@ -0,0 +1,35 @@
+#pragma once
+/*
+  Engine protocol.
+  ----------------
+  A line-based text protocol for driving the engine from GUIs, match
+  managers and scripts: one long-lived process plays any number of games.
+  Every command is one line; every reply is one line, flushed at once.
+  Moves and positions use the standard notation (see Notation.h).
+
+    isready                           -> readyok
+    newgame                           clear the hash table
+    position startpos [moves M...]    set the position, then play the moves
+    position fen FEN [moves M...]
+    fen                               -> fen FEN   (the current position)
+    go [movetime MS] [depth D] [infinite]
+                                      search in the background, then
+                                      -> bestmove M score S depth D nodes N time T
+                                         (bestmove M book / bestmove none)
+    stop                              end the search now; its bestmove follows
+    perft D                           -> perft D N time T
+    option hash MB | option threads N
+    stats [json|prometheus]           -> stats {...}   (see Stats.h), or the
+                                         Prometheus text up to "# EOF"
+    quit
+
+  Without a limit "go" searches for the default move time. While a search
+  runs only isready, stop, stats and quit are accepted, anything else is answered
+  with "error busy". Bad input gets "error <reason>" and changes nothing.
+
+  Command line:
+    engine [--hash MB] [--threads N] [--movetime MS] [--tb FILE] [--book FILE]
+           [--eval FILE]
+*/
+
+int engineCommand(int argc, char* argv[]);
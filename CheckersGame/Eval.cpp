@@ -0,0 +1,456 @@
+/*
+  Static evaluation and its tuning (see Eval.h).
+*/
+
+#include "Eval.h"
+#include "Records.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/* ------------------ Weights ------------------ */
+
+static const char* const TERM_NAMES[EVAL_TERMS] = {
+    "man", "king", "back-rank", "mobility", "centre", "tempo"
+};
+
+const char* evalTermName(int term) {
+    return (term >= 0 && term < EVAL_TERMS) ? TERM_NAMES[term] : "?";
+}
+
+EvalWeights defaultEvalWeights() {
+    EvalWeights w;
+    w.w[EVAL_MAN] = 100;
+    w.w[EVAL_KING] = 130;
+    w.w[EVAL_BACK_RANK] = 6;
+    w.w[EVAL_MOBILITY] = 3;
+    w.w[EVAL_CENTRE] = 4;
+    w.w[EVAL_TEMPO] = 1;
+    return w;
+}
+
+static EvalWeights weights = defaultEvalWeights();
+
+const EvalWeights& evalWeights() {
+    return weights;
+}
+
+void setEvalWeights(const EvalWeights& w) {
+    weights = w;
+}
+
+bool readEvalWeights(const char* path, EvalWeights& w, string& error) {
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        error = string("cannot open ") + path;
+        return false;
+    }
+
+    char line[256];
+    for (int lineNo = 1; fgets(line, sizeof(line), in); lineNo++) {
+        if (char* hash = strchr(line, '#')) *hash = 0;
+        char name[64];
+        int value;
+        int fields = sscanf(line, "%63s %d", name, &value);
+        if (fields <= 0) continue;   // blank or comment only
+
+        int term = -1;
+        for (int t = 0; t < EVAL_TERMS && fields == 2; t++)
+            if (strcmp(name, TERM_NAMES[t]) == 0) term = t;
+        if (term < 0) {
+            error = string(path) + ":" + to_string(lineNo) + ": expected \"name value\" with a known term";
+            fclose(in);
+            return false;
+        }
+        if (value < -EVAL_WEIGHT_LIMIT[term] || value > EVAL_WEIGHT_LIMIT[term]) {
+            error = string(path) + ":" + to_string(lineNo) + ": " + name + " must be within +/-" +
+                to_string(EVAL_WEIGHT_LIMIT[term]);
+            fclose(in);
+            return false;
+        }
+        w.w[term] = value;
+    }
+    fclose(in);
+    return true;
+}
+
+void writeEvalWeights(FILE* out, const EvalWeights& w) {
+    for (int t = 0; t < EVAL_TERMS; t++)
+        fprintf(out, "%s %d\n", TERM_NAMES[t], w.w[t]);
+}
+
+bool loadEvalWeights(const char* path) {
+    EvalWeights w = evalWeights();
+    string error;
+    if (!readEvalWeights(path, w, error)) {
+        fprintf(stderr, "eval: %s\n", error.c_str());
+        return false;
+    }
+    setEvalWeights(w);
+    return true;
+}
+
+/* ------------------ Features ------------------ */
+
+// Same row / column masks as the shifts in Board.cpp
+static constexpr uint32_t EVEN_ROWS = 0x0F0F0F0Fu;
+static constexpr uint32_t ODD_ROWS = 0xF0F0F0F0u;
+static constexpr uint32_t COL_A = 0x10101010u;
+static constexpr uint32_t COL_H = 0x08080808u;
+static constexpr uint32_t ROW_0 = 0x0000000Fu;
+static constexpr uint32_t ROW_7 = 0xF0000000u;
+static constexpr uint32_t CENTRE = 0x00666600u;   // c3-f6
+
+// Rows whose number has bit 0, 1, 2 set: a row-weighted count in three popcounts
+static constexpr uint32_t ROW_BIT0 = 0xF0F0F0F0u;
+static constexpr uint32_t ROW_BIT1 = 0xFF00FF00u;
+static constexpr uint32_t ROW_BIT2 = 0xFFFF0000u;
+
+// Squares with an empty square diagonally below / above them
+static uint32_t canStepDown(uint32_t empty) {
+    return ((empty & EVEN_ROWS & ~COL_H) >> 3) | ((empty & ODD_ROWS) >> 4)      // down-left
+         | ((empty & EVEN_ROWS) >> 4) | ((empty & ODD_ROWS & ~COL_A) >> 5);    // down-right
+}
+
+static uint32_t canStepUp(uint32_t empty) {
+    return ((empty & EVEN_ROWS) << 4) | ((empty & ODD_ROWS & ~COL_A) << 3)      // up-right
+         | ((empty & EVEN_ROWS & ~COL_H) << 5) | ((empty & ODD_ROWS) << 4);    // up-left
+}
+
+void evalFeatures(const Position& pos, int f[EVAL_TERMS]) {
+    uint32_t wMen = pos.white & ~pos.kings, bMen = pos.black & ~pos.kings;
+    uint32_t empty = ~(pos.white | pos.black);
+    uint32_t down = canStepDown(empty), up = canStepUp(empty);
+
+    // White moves down, black up, kings both ways
+    uint32_t wMovers = (pos.white & down) | (pos.white & pos.kings & up);
+    uint32_t bMovers = (pos.black & up) | (pos.black & pos.kings & down);
+
+    f[EVAL_MAN] = popcount(wMen) - popcount(bMen);
+    f[EVAL_KING] = popcount(pos.white & pos.kings) - popcount(pos.black & pos.kings);
+    f[EVAL_BACK_RANK] = popcount(wMen & ROW_0) - popcount(bMen & ROW_7);
+    f[EVAL_MOBILITY] = popcount(wMovers) - popcount(bMovers);
+    f[EVAL_CENTRE] = popcount(pos.white & CENTRE) - popcount(pos.black & CENTRE);
+
+    // White men count their row, black men 7 - row (the complementary bits)
+    f[EVAL_TEMPO] = popcount(wMen & ROW_BIT0) + 2 * popcount(wMen & ROW_BIT1) + 4 * popcount(wMen & ROW_BIT2)
+        - popcount(bMen & ~ROW_BIT0) - 2 * popcount(bMen & ~ROW_BIT1) - 4 * popcount(bMen & ~ROW_BIT2);
+}
+
+int evaluate(const Position& pos, Player side, const EvalWeights& w) {
+    int f[EVAL_TERMS];
+    evalFeatures(pos, f);
+    int score = 0;
+    for (int t = 0; t < EVAL_TERMS; t++) score += w.w[t] * f[t];
+    return (side == WHITE) ? score : -score;
+}
+
+int evaluate(const Position& pos, Player side) {
+    return evaluate(pos, side, weights);
+}
+
+/* ------------------ Batched evaluation ------------------ */
+
+static Position batchPosition(const PositionBatch& b, size_t i) {
+    Position pos = {};
+    pos.white = b.white[i];
+    pos.black = b.black[i];
+    pos.kings = b.kings[i];
+    return pos;
+}
+
+#ifdef __AVX2__
+
+// Popcount of each 32-bit lane: nibble lookup, then sum the bytes of a lane
+static inline __m256i popcount8(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    __m256i pairs = _mm256_maddubs_epi16(_mm256_add_epi8(lo, hi), _mm256_set1_epi8(1));
+    return _mm256_madd_epi16(pairs, _mm256_set1_epi16(1));
+}
+
+static inline __m256i andv(__m256i a, uint32_t mask) {
+    return _mm256_and_si256(a, _mm256_set1_epi32((int)mask));
+}
+
+// popcount(a & ma) - popcount(b & mb)
+static inline __m256i countDiff(__m256i a, uint32_t ma, __m256i b, uint32_t mb) {
+    return _mm256_sub_epi32(popcount8(andv(a, ma)), popcount8(andv(b, mb)));
+}
+
+// evalFeatures() for eight positions
+static void features8(const PositionBatch& b, size_t i, __m256i f[EVAL_TERMS]) {
+    __m256i w = _mm256_loadu_si256((const __m256i*)(b.white + i));
+    __m256i bl = _mm256_loadu_si256((const __m256i*)(b.black + i));
+    __m256i k = _mm256_loadu_si256((const __m256i*)(b.kings + i));
+
+    __m256i wMen = _mm256_andnot_si256(k, w), bMen = _mm256_andnot_si256(k, bl);
+    __m256i wKings = _mm256_and_si256(w, k), bKings = _mm256_and_si256(bl, k);
+    __m256i empty = _mm256_xor_si256(_mm256_or_si256(w, bl), _mm256_set1_epi32(-1));
+
+    __m256i even = andv(empty, EVEN_ROWS), odd = andv(empty, ODD_ROWS);
+    __m256i evenNoH = andv(empty, EVEN_ROWS & ~COL_H), oddNoA = andv(empty, ODD_ROWS & ~COL_A);
+    __m256i down = _mm256_or_si256(_mm256_or_si256(_mm256_srli_epi32(evenNoH, 3), _mm256_srli_epi32(odd, 4)),
+                                   _mm256_or_si256(_mm256_srli_epi32(even, 4), _mm256_srli_epi32(oddNoA, 5)));
+    __m256i up = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(even, 4), _mm256_slli_epi32(oddNoA, 3)),
+                                 _mm256_or_si256(_mm256_slli_epi32(evenNoH, 5), _mm256_slli_epi32(odd, 4)));
+    __m256i wMovers = _mm256_or_si256(_mm256_and_si256(w, down), _mm256_and_si256(wKings, up));
+    __m256i bMovers = _mm256_or_si256(_mm256_and_si256(bl, up), _mm256_and_si256(bKings, down));
+
+    f[EVAL_MAN] = _mm256_sub_epi32(popcount8(wMen), popcount8(bMen));
+    f[EVAL_KING] = _mm256_sub_epi32(popcount8(wKings), popcount8(bKings));
+    f[EVAL_BACK_RANK] = countDiff(wMen, ROW_0, bMen, ROW_7);
+    f[EVAL_MOBILITY] = _mm256_sub_epi32(popcount8(wMovers), popcount8(bMovers));
+    f[EVAL_CENTRE] = countDiff(w, CENTRE, bl, CENTRE);
+
+    __m256i t0 = countDiff(wMen, ROW_BIT0, bMen, ~ROW_BIT0);
+    __m256i t1 = countDiff(wMen, ROW_BIT1, bMen, ~ROW_BIT1);
+    __m256i t2 = countDiff(wMen, ROW_BIT2, bMen, ~ROW_BIT2);
+    f[EVAL_TEMPO] = _mm256_add_epi32(t0, _mm256_add_epi32(_mm256_slli_epi32(t1, 1), _mm256_slli_epi32(t2, 2)));
+}
+
+void evaluateBatch(const PositionBatch& b, int* out) {
+    __m256i wt[EVAL_TERMS];
+    for (int t = 0; t < EVAL_TERMS; t++) wt[t] = _mm256_set1_epi32(weights.w[t]);
+    const __m256i black = _mm256_set1_epi32(BLACK);
+
+    size_t i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        __m256i f[EVAL_TERMS];
+        features8(b, i, f);
+        __m256i score = _mm256_setzero_si256();
+        for (int t = 0; t < EVAL_TERMS; t++)
+            score = _mm256_add_epi32(score, _mm256_mullo_epi32(f[t], wt[t]));
+
+        // Negate (x ^ -1) + 1 where black is to move
+        __m256i side = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(b.side + i)));
+        __m256i neg = _mm256_cmpeq_epi32(side, black);
+        score = _mm256_sub_epi32(_mm256_xor_si256(score, neg), neg);
+        _mm256_storeu_si256((__m256i*)(out + i), score);
+    }
+    for (; i < b.count; i++) out[i] = evaluate(batchPosition(b, i), (Player)b.side[i]);
+}
+
+void evalFeaturesBatch(const PositionBatch& b, int16_t* features) {
+    size_t i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        __m256i f[EVAL_TERMS];
+        features8(b, i, f);
+        for (int t = 0; t < EVAL_TERMS; t++) {
+            // Pack to 16 bits; packs works per 128-bit half, so gather the halves
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(f[t], f[t]), 0x08);
+            _mm_storeu_si128((__m128i*)(features + t * b.count + i), _mm256_castsi256_si128(packed));
+        }
+    }
+    for (; i < b.count; i++) {
+        int f[EVAL_TERMS];
+        evalFeatures(batchPosition(b, i), f);
+        for (int t = 0; t < EVAL_TERMS; t++) features[t * b.count + i] = (int16_t)f[t];
+    }
+}
+
+#else
+
+void evaluateBatch(const PositionBatch& b, int* out) {
+    for (size_t i = 0; i < b.count; i++) out[i] = evaluate(batchPosition(b, i), (Player)b.side[i]);
+}
+
+void evalFeaturesBatch(const PositionBatch& b, int16_t* features) {
+    for (size_t i = 0; i < b.count; i++) {
+        int f[EVAL_TERMS];
+        evalFeatures(batchPosition(b, i), f);
+        for (int t = 0; t < EVAL_TERMS; t++) features[t * b.count + i] = (int16_t)f[t];
+    }
+}
+
+#endif
+
+/* ------------------ Texel tuning ------------------ */
+
+struct TuneOptions {
+    int iterations = 300;
+    double rate = 1.0;      // Adam step, in score units
+    size_t limit = 0;       // 0 = every position
+    const char* out = "eval.txt";
+};
+
+// Quiet positions of the record files with the result for the side to move
+struct TuneData {
+    vector<uint32_t> white, black, kings;
+    vector<uint8_t> side;
+    vector<float> target;   // 1 win, 0.5 draw, 0 loss, for the side to move
+
+    PositionBatch batch() const {
+        return { white.data(), black.data(), kings.data(), side.data(), white.size() };
+    }
+};
+
+static double sigmoid(double x) {
+    return 1.0 / (1.0 + exp(-x));
+}
+
+// Mean squared error of sigmoid(K * score) against the results
+static double scoreError(const TuneData& data, const vector<int>& scores, double k) {
+    double sum = 0;
+    for (size_t i = 0; i < scores.size(); i++) {
+        double d = sigmoid(k * scores[i]) - data.target[i];
+        sum += d * d;
+    }
+    return sum / (double)scores.size();
+}
+
+// K minimising the error of the current weights (ternary search on log K)
+static double fitScale(const TuneData& data, const vector<int>& scores) {
+    double lo = log(1e-4), hi = log(1.0);
+    for (int it = 0; it < 60; it++) {
+        double a = lo + (hi - lo) / 3, b = hi - (hi - lo) / 3;
+        if (scoreError(data, scores, exp(a)) < scoreError(data, scores, exp(b))) hi = b;
+        else lo = a;
+    }
+    return exp((lo + hi) / 2);
+}
+
+static bool loadTuneData(int files, char* paths[], size_t limit, TuneData& data, uint64_t& total) {
+    total = 0;
+    for (int f = 0; f < files; f++) {
+        RecordFile rf;
+        if (!rf.open(paths[f])) {
+            fprintf(stderr, "tune: cannot open %s\n", paths[f]);
+            return false;
+        }
+        for (const PositionRecord& r : rf) {
+            total++;
+            if (limit && data.white.size() >= limit) break;
+            Position pos = r.position();
+            Player side = (Player)r.side;
+            if (capturers(pos, side) || !movers(pos, side)) continue;   // not quiet, or lost
+            data.white.push_back(r.white);
+            data.black.push_back(r.black);
+            data.kings.push_back(r.kings);
+            data.side.push_back(r.side);
+            data.target.push_back(0.5f * (float)(r.result + 1));
+        }
+    }
+    return !data.white.empty();
+}
+
+static int tune(int files, char* paths[], const TuneOptions& opt) {
+    TuneData data;
+    uint64_t total;
+    auto start = chrono::steady_clock::now();
+    if (!loadTuneData(files, paths, opt.limit, data, total)) {
+        if (files > 0) fprintf(stderr, "tune: no quiet positions\n");
+        return 1;
+    }
+    size_t n = data.white.size();
+    PositionBatch batch = data.batch();
+
+    // Features once (term-major), results seen from WHITE like the features
+    vector<int16_t> packed(n * EVAL_TERMS);
+    evalFeaturesBatch(batch, packed.data());
+    vector<float> feat(packed.begin(), packed.end());
+    vector<float> y(n);
+    for (size_t i = 0; i < n; i++) y[i] = (data.side[i] == WHITE) ? data.target[i] : 1.0f - data.target[i];
+
+    vector<int> scores(n);
+    evaluateBatch(batch, scores.data());
+    double k = fitScale(data, scores);
+    printf("positions %zu (quiet, of %llu)  K %.6f  error %.6f\n", n, (unsigned long long)total,
+        k, scoreError(data, scores, k));
+
+    // Adam on the weights, K fixed
+    double w[EVAL_TERMS], m[EVAL_TERMS] = {}, v[EVAL_TERMS] = {};
+    for (int t = 0; t < EVAL_TERMS; t++) w[t] = evalWeights().w[t];
+    vector<float> e(n), r(n);
+    for (int it = 1; it <= opt.iterations; it++) {
+        fill(e.begin(), e.end(), 0.0f);
+        for (int t = 0; t < EVAL_TERMS; t++) {
+            const float* ft = feat.data() + t * n;
+            float wt = (float)w[t];
+            for (size_t i = 0; i < n; i++) e[i] += wt * ft[i];
+        }
+
+        double err = 0;
+        float kf = (float)k;
+        for (size_t i = 0; i < n; i++) {
+            float p = 1.0f / (1.0f + expf(-kf * e[i]));
+            float d = p - y[i];
+            err += d * d;
+            r[i] = d * p * (1 - p);
+        }
+
+        for (int t = 0; t < EVAL_TERMS; t++) {
+            const float* ft = feat.data() + t * n;
+            double g = 0;
+            for (size_t i = 0; i < n; i++) g += r[i] * ft[i];
+            g *= 2 * k / (double)n;
+            m[t] = 0.9 * m[t] + 0.1 * g;
+            v[t] = 0.999 * v[t] + 0.001 * g * g;
+            double mh = m[t] / (1 - pow(0.9, it)), vh = v[t] / (1 - pow(0.999, it));
+            w[t] -= opt.rate * mh / (sqrt(vh) + 1e-12);
+        }
+        if (it % 50 == 0 || it == opt.iterations) printf("iteration %4d  error %.6f\n", it, err / (double)n);
+    }
+
+    EvalWeights tuned;
+    for (int t = 0; t < EVAL_TERMS; t++) {
+        double limit = EVAL_WEIGHT_LIMIT[t];
+        if (fabs(w[t]) > limit) printf("%s clamped to +/-%d\n", TERM_NAMES[t], EVAL_WEIGHT_LIMIT[t]);
+        tuned.w[t] = (int)lround(clamp(w[t], -limit, limit));
+    }
+    setEvalWeights(tuned);
+    evaluateBatch(batch, scores.data());
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("rounded weights: error %.6f  (%.1fs)\n", scoreError(data, scores, k), secs);
+    writeEvalWeights(stdout, tuned);
+
+    FILE* out = fopen(opt.out, "w");
+    if (!out) {
+        fprintf(stderr, "tune: cannot write %s\n", opt.out);
+        return 1;
+    }
+    fprintf(out, "# Texel-tuned on %zu positions\n", n);
+    writeEvalWeights(out, tuned);
+    fclose(out);
+    return 0;
+}
+
+int tuneCommand(int argc, char* argv[]) {
+    TuneOptions opt;
+    vector<char*> files;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        bool hasVal = i + 1 < argc;
+        if (arg == "--iterations" && hasVal) opt.iterations = atoi(argv[++i]);
+        else if (arg == "--rate" && hasVal) opt.rate = atof(argv[++i]);
+        else if (arg == "--limit" && hasVal) opt.limit = (size_t)atoll(argv[++i]);
+        else if (arg == "--out" && hasVal) opt.out = argv[++i];
+        else if (arg == "--start" && hasVal) {
+            if (!loadEvalWeights(argv[++i])) return 1;
+        }
+        else if (arg.size() > 1 && arg[0] == '-') {
+            files.clear();
+            break;
+        }
+        else files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        fprintf(stderr, "usage: tune RECORDS... [--iterations N] [--rate R] [--start FILE] [--limit N] [--out FILE]\n");
+        return 1;
+    }
+    return tune((int)files.size(), files.data(), opt);
+}
@@ -0,0 +1,112 @@
+#pragma once
+/*
+  Static evaluation.
+  ------------------
+  A weighted sum of simple features, each counted for WHITE minus BLACK:
+    man        men
+    king       kings
+    back-rank  men still guarding their own back row
+    mobility   pieces with a simple move
+    centre     pieces on the eight central squares (c3-f6)
+    tempo      how far the men have advanced, in rows
+  The score is returned from the point of view of the side to move.
+
+  Weights come with built-in defaults and can be loaded from a text file,
+  one "name value" pair per line ('#' starts a comment):
+    man 100
+    king 130
+  Terms missing from the file keep their defaults. A weight outside its
+  range (EVAL_WEIGHT_LIMIT below) is an error.
+
+  Batched evaluation scores many positions stored as arrays (one array per
+  mask). With AVX2 it works on eight positions per instruction, popcounts
+  included, which is what the tuner uses on millions of positions.
+
+  Command line:
+    tune RECORDS... [--iterations N] [--rate R] [--start FILE]
+                    [--limit N] [--out FILE]
+  Texel tuning: fits the weights so that a logistic function of the score
+  predicts the game results of the quiet positions in record files
+  (see Records.h), then writes them as a weights file.
+*/
+
+#include "Board.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+enum EvalTerm {
+    EVAL_MAN = 0,
+    EVAL_KING,
+    EVAL_BACK_RANK,
+    EVAL_MOBILITY,
+    EVAL_CENTRE,
+    EVAL_TEMPO,
+    EVAL_TERMS
+};
+
+const char* evalTermName(int term);
+
+struct EvalWeights {
+    int w[EVAL_TERMS];
+};
+
+/*
+  Every weight must satisfy |w| <= EVAL_WEIGHT_LIMIT[term]. A side has at
+  most EVAL_FEATURE_MAX[term] of each feature (12 men or kings, 4 back-rank
+  men, 12 movers, 8 centre pieces, 12 men 6 rows up), so no static score
+  exceeds MAX_EVAL_SCORE: far from the win scores of the search and inside
+  the 16-bit scores of the transposition table.
+*/
+constexpr int EVAL_WEIGHT_LIMIT[EVAL_TERMS] = { 400, 400, 100, 100, 100, 20 };
+constexpr int EVAL_FEATURE_MAX[EVAL_TERMS] = { 12, 12, 4, 12, 8, 72 };
+
+constexpr int maxEvalScore() {
+    int sum = 0;
+    for (int t = 0; t < EVAL_TERMS; t++) sum += EVAL_WEIGHT_LIMIT[t] * EVAL_FEATURE_MAX[t];
+    return sum;
+}
+constexpr int MAX_EVAL_SCORE = maxEvalScore();
+
+// The built-in weights
+EvalWeights defaultEvalWeights();
+
+/*
+  Weights used by evaluate() and evaluateBatch(). Set them before any
+  search starts; they are read without locking.
+*/
+const EvalWeights& evalWeights();
+void setEvalWeights(const EvalWeights& w);
+
+// Read a weights file over 'w'; false with a message in 'error' on failure
+bool readEvalWeights(const char* path, EvalWeights& w, std::string& error);
+void writeEvalWeights(FILE* out, const EvalWeights& w);
+
+// Load a weights file into evalWeights(); prints the error and returns false on failure
+bool loadEvalWeights(const char* path);
+
+// Static evaluation from the point of view of the side to move
+int evaluate(const Position& pos, Player side);
+int evaluate(const Position& pos, Player side, const EvalWeights& w);
+
+// Feature values of one position, WHITE minus BLACK
+void evalFeatures(const Position& pos, int features[EVAL_TERMS]);
+
+// Many positions, structure of arrays
+struct PositionBatch {
+    const uint32_t* white;
+    const uint32_t* black;
+    const uint32_t* kings;
+    const uint8_t* side;     // Player to move
+    size_t count;
+};
+
+// out[i] = evaluate(position i, side i)
+void evaluateBatch(const PositionBatch& batch, int* out);
+
+// features[t * batch.count + i] = feature t of position i
+void evalFeaturesBatch(const PositionBatch& batch, int16_t* features);
+
+int tuneCommand(int argc, char* argv[]);
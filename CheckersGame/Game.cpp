@@ -0,0 +1,57 @@
+/*
+  One game of checkers (see Game.h).
+*/
+
+#include "Game.h"
+
+using namespace std;
+
+const char* gameStatusName(GameStatus s) {
+    switch (s) {
+    case GAME_ON:          return "on";
+    case GAME_NO_PIECES:   return "no-pieces";
+    case GAME_NO_MOVES:    return "no-moves";
+    case GAME_REPETITION:  return "repetition";
+    case GAME_NO_PROGRESS: return "no-progress";
+    }
+    return "?";
+}
+
+void Game::reset() {
+    Position initial;
+    initBoard(initial);
+    reset(initial, WHITE);
+}
+
+void Game::reset(const Position& startPos, Player startSide) {
+    start = pos = startPos;
+    startTurn = side = startSide;
+    history.clear();
+    positions.reset(positionKey(pos, side));
+    update();
+}
+
+bool Game::play(const Move& m) {
+    bool found = false;
+    for (const Move& l : legal)
+        if (l.from == m.from && l.to == m.to && l.captured == m.captured && l.path == m.path) found = true;
+    if (!found) return false;
+
+    bool progress = isProgress(pos, m);
+    applyMove(pos, m);
+    maybePromote(pos, m.to);
+    history.push_back(m);
+    side = opponent(side);
+    positions.push(positionKey(pos, side), progress);
+    update();
+    return true;
+}
+
+void Game::update() {
+    allLegalMoves(pos, side, legal);
+    if (countPieces(pos, side) == 0) state = GAME_NO_PIECES;
+    else if (legal.empty()) state = GAME_NO_MOVES;
+    else if (positions.repetitionDraw()) state = GAME_REPETITION;
+    else if (positions.noProgressDraw()) state = GAME_NO_PROGRESS;
+    else state = GAME_ON;
+}
@@ -0,0 +1,75 @@
+#pragma once
+/*
+  One game of checkers.
+  ---------------------
+  Owns everything a game needs: the start position, the current position,
+  the side to move and the moves played so far. Nothing is global, so a
+  process can run any number of games side by side (see Server.h).
+  - The legal moves of the current position are generated once per move
+    and kept, so asking for them repeatedly is free. Captures are
+    compulsory, so the list holds either only captures or none, and
+    mustCapture() needs no board scan of its own.
+  - play() only accepts a move of that list and updates the game state.
+  - The positions played are kept for the draw rules (see Repetition.h);
+    searchHistory() hands them to the search.
+*/
+
+#include "Board.h"
+#include "Repetition.h"
+
+#include <cstdint>
+#include <vector>
+
+enum GameStatus : uint8_t {
+    GAME_ON = 0,
+    GAME_NO_PIECES = 1,   // side to move has no pieces left: it loses
+    GAME_NO_MOVES = 2,    // side to move has no legal move: it loses
+    GAME_REPETITION = 3,  // threefold repetition: draw
+    GAME_NO_PROGRESS = 4  // 40-move rule: draw
+};
+
+const char* gameStatusName(GameStatus s);
+
+class Game {
+public:
+    Game() {
+        history.reserve(256);   // a whole typical game: reset() keeps the capacity
+        reset();
+    }
+
+    // Start over from the standard start, or from any position
+    void reset();
+    void reset(const Position& start, Player side);
+
+    const Position& position() const { return pos; }
+    Player turn() const { return side; }
+    const Position& startPosition() const { return start; }
+    Player startSide() const { return startTurn; }
+    const std::vector<Move>& moves() const { return history; }
+    const MoveList& legalMoves() const { return legal; }
+
+    // Does the side to move have to capture?
+    bool mustCapture() const { return !legal.empty() && legal[0].isCapture(); }
+
+    // False (and nothing changes) if the move is not legal here
+    bool play(const Move& m);
+
+    GameStatus status() const { return state; }
+    bool over() const { return state != GAME_ON; }
+    bool drawn() const { return state == GAME_REPETITION || state == GAME_NO_PROGRESS; }
+
+    // 0 while the game goes on or if it was drawn, otherwise the Player who won
+    int winner() const { return (over() && !drawn()) ? opponent(side) : 0; }
+
+    void searchHistory(SearchHistory& out) const { positions.searchHistory(out); }
+
+private:
+    void update();
+
+    Position start, pos;
+    Player startTurn = WHITE, side = WHITE;
+    std::vector<Move> history;
+    PositionHistory positions;
+    MoveList legal;
+    GameStatus state = GAME_ON;
+};
@@ -0,0 +1,112 @@
+/*
+  Line-based input (see Input.h).
+*/
+
+#include "Input.h"
+#include "Board.h"
+#include "Stats.h"
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+  Wait until fd has data (or is at its end). On Windows the wait works on
+  the underlying handle; a console also wakes up on non-key events, the
+  following read then simply blocks until a line is typed.
+*/
+bool LineReader::waitReadable(int timeoutMs) {
+    if (timeoutMs < 0) return true;
+#ifdef _WIN32
+    HANDLE h = (HANDLE)_get_osfhandle(fd);
+    return WaitForSingleObject(h, (DWORD)timeoutMs) == WAIT_OBJECT_0;
+#else
+    pollfd p = { fd, POLLIN, 0 };
+    int n;
+    do n = poll(&p, 1, timeoutMs); while (n < 0 && errno == EINTR);
+    return n != 0;
+#endif
+}
+
+ReadStatus LineReader::readLine(string_view& line, int timeoutMs) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs < 0 ? 0 : timeoutMs);
+    start = next;   // the previous line is no longer needed
+
+    while (true) {
+        const char* nl = (const char*)memchr(buf + start, '\n', end - start);
+        if (nl || eof || (start == 0 && end == sizeof(buf))) {
+            size_t len = nl ? size_t(nl - (buf + start)) : end - start;
+            if (!nl && len == 0) return READ_EOF;
+            next = start + len + (nl ? 1 : 0);
+            STAT_INC(STAT_INPUT_LINES);
+            STAT_ADD(STAT_INPUT_BYTES, next - start);
+            if (len > 0 && buf[start + len - 1] == '\r') len--;
+            line = string_view(buf + start, len);
+            return READ_OK;
+        }
+
+        // Keep the unfinished line at the front and read more behind it
+        memmove(buf, buf + start, end - start);
+        end -= start;
+        start = next = 0;
+
+        int wait = -1;
+        if (timeoutMs >= 0) {
+            auto left = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            wait = left.count() > 0 ? (int)left.count() : 0;
+        }
+        STAT_TIMER(TIMER_INPUT_WAIT);   // until the read below returns
+        if (!waitReadable(wait)) return READ_TIMEOUT;
+
+#ifdef _WIN32
+        int n = _read(fd, buf + end, (unsigned)(sizeof(buf) - end));
+#else
+        ssize_t n = read(fd, buf + end, sizeof(buf) - end);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) eof = true;
+        else end += (size_t)n;
+    }
+}
+
+string_view nextWord(string_view& rest) {
+    size_t i = 0;
+    while (i < rest.size() && isspace((unsigned char)rest[i])) i++;
+    size_t j = i;
+    while (j < rest.size() && !isspace((unsigned char)rest[j])) j++;
+    string_view word = rest.substr(i, j - i);
+    rest.remove_prefix(j);
+    return word;
+}
+
+bool parseSquare(string_view word, int& r, int& c) {
+    if (word.size() < 2) return false;
+
+    char file = 0;
+    char rank = 0;
+
+    for (char ch : word) {
+        if (isalpha((unsigned char)ch)) { file = (char)tolower(ch); break; }
+    }
+    for (char ch : word) {
+        if (isdigit((unsigned char)ch)) { rank = ch; break; }
+    }
+
+    if (file < 'a' || file > 'h') return false;
+    if (rank < '1' || rank > '8') return false;
+
+    c = file - 'a';
+    r = rank - '1';
+    return inBounds(r, c);
+}
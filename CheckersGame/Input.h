@@ -0,0 +1,50 @@
+#pragma once
+/*
+  Line-based input.
+  -----------------
+  LineReader reads whole lines from a file descriptor (stdin, a pipe or,
+  on POSIX, a socket) into a fixed buffer and hands them out in place as
+  string_views, valid until the next call:
+  - end of input and a closed pipe are reported as READ_EOF, never as an
+    endless stream of empty reads
+  - an optional timeout bounds the wait for a line
+  - '\r\n' line ends are accepted; a line longer than the buffer comes
+    out in buffer-sized pieces
+
+  The parsing helpers below work on string_views too, so reading and
+  decoding a move never builds a std::string.
+*/
+
+#include <cstddef>
+#include <string_view>
+
+enum ReadStatus {
+    READ_OK,
+    READ_EOF,
+    READ_TIMEOUT
+};
+
+class LineReader {
+public:
+    explicit LineReader(int fd = 0) : fd(fd) {}
+
+    // timeoutMs < 0: wait as long as it takes
+    ReadStatus readLine(std::string_view& line, int timeoutMs = -1);
+
+private:
+    bool waitReadable(int timeoutMs);
+
+    int fd;
+    char buf[4096];
+    size_t start = 0, next = 0, end = 0;
+    bool eof = false;
+};
+
+// Split off the next whitespace-separated word of 'rest' ("" at the end)
+std::string_view nextWord(std::string_view& rest);
+
+/*
+  Parse a square from a word like "b6", "B6" or "b6,":
+  the first letter a-h is the file (column), the first digit 1-8 the rank (row).
+*/
+bool parseSquare(std::string_view word, int& r, int& c);
@@ -0,0 +1,80 @@
+/*
+  Read-only memory-mapped file (see MappedFile.h).
+*/
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path) {
+    close();
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size) || size.QuadPart == 0) {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (m) CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+
+    file = f;
+    mapping = m;
+    base = (const uint8_t*)view;
+    length = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle((HANDLE)mapping);
+    if (file) CloseHandle((HANDLE)file);
+    base = nullptr;
+    length = 0;
+    file = mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // the mapping keeps the file alive
+    if (p == MAP_FAILED) return false;
+
+    base = (const uint8_t*)p;
+    length = (size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) munmap((void*)base, length);
+    base = nullptr;
+    length = 0;
+}
+
+#endif
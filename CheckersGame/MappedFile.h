@@ -0,0 +1,36 @@
+#pragma once
+/*
+  Read-only memory-mapped file.
+  -----------------------------
+  The operating system pages the file in on first access, so opening even
+  a very large data file costs nothing up front and the pages are shared
+  between processes. mmap on POSIX, CreateFileMapping on Windows.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the whole file; false if it cannot be opened (or is empty)
+    bool open(const char* path);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,163 @@
+/*
+  Text form of squares and moves (see Notation.h).
+*/
+
+#include "Notation.h"
+
+#include <cctype>
+
+using namespace std;
+
+string squareName(int sq) {
+    string s;
+    s += char('a' + sqCol(sq));
+    s += char('1' + sqRow(sq));
+    return s;
+}
+
+string moveName(const Move& m) {
+    string s = squareName(m.from);
+    if (!m.isCapture()) return s + "-" + squareName(m.to);
+    for (int i = 0; i < m.jumps; i++)
+        s += "x" + squareName(m.landing(i));
+    return s;
+}
+
+string pdnMoveName(const Move& m) {
+    string s = to_string(m.from + 1);
+    if (!m.isCapture()) return s + "-" + to_string(m.to + 1);
+    for (int i = 0; i < m.jumps; i++)
+        s += "x" + to_string(m.landing(i) + 1);
+    return s;
+}
+
+MoveParse parsePdnMove(const string& text, const Position& pos, Player side, Move& out) {
+    int squares[16];
+    int n = 0;
+    bool capture = false, ok = true;
+    size_t i = 0;
+    while (ok && i < text.size()) {
+        if (!isdigit((unsigned char)text[i])) {
+            ok = false;
+            break;
+        }
+        int v = 0;
+        while (i < text.size() && isdigit((unsigned char)text[i])) v = v * 10 + (text[i++] - '0');
+        ok = v >= 1 && v <= 32 && n < 16;
+        if (ok) squares[n++] = v - 1;
+
+        if (i < text.size()) {
+            char sep = text[i++];
+            if (sep == 'x' || sep == 'X' || sep == ':') capture = true;
+            else if (sep != '-') ok = false;
+            if (i == text.size()) ok = false;
+        }
+    }
+    if (!ok || n < 2) return MOVE_BAD;
+
+    MoveList legal;
+    allLegalMoves(pos, side, legal);
+    const Move* found = nullptr;
+    bool ambiguous = false;
+    for (const Move& m : legal) {
+        if (m.from != squares[0] || m.isCapture() != capture || m.to != squares[n - 1]) continue;
+        if (capture && n > 2) {
+            bool same = m.jumps == n - 1;
+            for (int j = 0; same && j < m.jumps; j++) same = m.landing(j) == squares[j + 1];
+            if (!same) continue;
+        }
+        if (found && found->captured != m.captured) ambiguous = true;
+        if (!found) found = &m;
+    }
+    if (!found) return MOVE_ILLEGAL;
+    if (ambiguous) return MOVE_AMBIGUOUS;
+    out = *found;
+    return MOVE_OK;
+}
+
+/* ------------------ FEN ------------------ */
+
+// One side's list: "K1,5-8,K30" (may be empty); sets the bits of 'pieces' / 'kings'
+static bool parsePieceList(const string& list, uint32_t& pieces, uint32_t& kings) {
+    size_t i = 0;
+    while (i < list.size()) {
+        bool king = false;
+        if (list[i] == 'K' || list[i] == 'k') {
+            king = true;
+            i++;
+        }
+        int first = 0, last = 0;
+        if (i == list.size() || !isdigit((unsigned char)list[i])) return false;
+        while (i < list.size() && isdigit((unsigned char)list[i])) first = first * 10 + (list[i++] - '0');
+        last = first;
+        if (i < list.size() && list[i] == '-') {
+            i++;
+            if (i == list.size() || !isdigit((unsigned char)list[i])) return false;
+            last = 0;
+            while (i < list.size() && isdigit((unsigned char)list[i])) last = last * 10 + (list[i++] - '0');
+        }
+        if (first < 1 || last > 32 || first > last) return false;
+        for (int n = first; n <= last; n++) {
+            uint32_t bit = 1u << (n - 1);
+            if (pieces & bit) return false;
+            pieces |= bit;
+            if (king) kings |= bit;
+        }
+        if (i < list.size() && list[i++] != ',') return false;
+    }
+    return true;
+}
+
+bool parseFen(const string& text, Position& pos, Player& side) {
+    string fen;
+    for (char ch : text)
+        if (!isspace((unsigned char)ch)) fen += ch;
+    if (!fen.empty() && fen.back() == '.') fen.pop_back();
+
+    // "<side>:<colour><list>:<colour><list>"
+    size_t c1 = fen.find(':');
+    size_t c2 = (c1 == string::npos) ? c1 : fen.find(':', c1 + 1);
+    if (c1 != 1 || c2 == string::npos || fen.find(':', c2 + 1) != string::npos) return false;
+
+    char toMove = (char)toupper((unsigned char)fen[0]);
+    string part[2] = { fen.substr(c1 + 1, c2 - c1 - 1), fen.substr(c2 + 1) };
+
+    // Standard Black = our WHITE, standard White = our BLACK
+    uint32_t white = 0, black = 0, kings = 0;
+    bool seen[2] = { false, false };
+    for (const string& p : part) {
+        if (p.empty()) return false;
+        char colour = (char)toupper((unsigned char)p[0]);
+        int idx = (colour == 'B') ? 0 : (colour == 'W') ? 1 : -1;
+        if (idx < 0 || seen[idx]) return false;
+        seen[idx] = true;
+        if (!parsePieceList(p.substr(1), idx == 0 ? white : black, kings)) return false;
+    }
+    if ((toMove != 'B' && toMove != 'W') || (white & black)) return false;
+
+    // Men never stand on their crowning row
+    if ((white & ~kings & 0xF0000000u) || (black & ~kings & 0x0000000Fu)) return false;
+
+    pos.white = white;
+    pos.black = black;
+    pos.kings = kings;
+    refreshKey(pos);
+    side = (toMove == 'B') ? WHITE : BLACK;
+    return true;
+}
+
+static string pieceList(uint32_t pieces, uint32_t kings) {
+    string s;
+    for (int sq = 0; sq < 32; sq++) {
+        if (!(pieces & (1u << sq))) continue;
+        if (!s.empty()) s += ',';
+        if (kings & (1u << sq)) s += 'K';
+        s += to_string(sq + 1);
+    }
+    return s;
+}
+
+string positionFen(const Position& pos, Player side) {
+    return string(side == WHITE ? "B" : "W") + ":W" + pieceList(pos.black, pos.kings)
+        + ":B" + pieceList(pos.white, pos.kings);
+}
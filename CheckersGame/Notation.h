@@ -0,0 +1,41 @@
+#pragma once
+/*
+  Text form of squares and moves.
+  -------------------------------
+  Squares use the on-screen coordinates: file a-h, rank 1-8 ("b6").
+  Moves join the squares with '-' for a step and 'x' for every jump:
+    "b3-a4", "a3xc5xe7"
+
+  Game records (PDN) use the standard numbering 1..32 instead, which is
+  simply square index + 1: "9-13", "22x15x8". The side we call WHITE
+  (moving first, from the top) is "Black" in standard notation.
+
+  Positions use checkers FEN with the same numbering and colours:
+    "B:W21-32:B1-12"        start position, Black (our WHITE) to move
+    "W:WK3,28:B5,K30"       side to move, then each side's pieces; K = king
+  Ranges "a-b" are accepted when parsing; lists are written one by one.
+*/
+
+#include "Board.h"
+
+#include <string>
+
+std::string squareName(int sq);
+std::string moveName(const Move& m);
+std::string pdnMoveName(const Move& m);
+
+/*
+  Find the legal move written in PDN ("9-13", "22x15x8"). A capture may be
+  given by its end points only, as long as that leaves one possible result.
+*/
+enum MoveParse {
+    MOVE_OK,
+    MOVE_BAD,          // not move text
+    MOVE_ILLEGAL,      // no legal move matches
+    MOVE_AMBIGUOUS     // several captures with different results match
+};
+MoveParse parsePdnMove(const std::string& text, const Position& pos, Player side, Move& out);
+
+// False (and pos untouched) if the text is not a valid position
+bool parseFen(const std::string& fen, Position& pos, Player& side);
+std::string positionFen(const Position& pos, Player side);
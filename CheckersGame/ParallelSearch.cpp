@@ -0,0 +1,138 @@
+/*
+  Multi-threaded search (see ParallelSearch.h).
+*/
+
+#include "ParallelSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+
+ParallelSearch::ParallelSearch(TransTable& table, int threads) : tt(table) {
+    setThreads(threads);
+}
+
+void ParallelSearch::setThreads(int n) {
+    if (n < 1) n = 1;
+    searchers.clear();
+    for (int i = 0; i < n; i++) {
+        searchers.push_back(make_unique<Searcher>(tt));
+        searchers.back()->setHelper(&stopAll, i);
+        searchers.back()->setTablebase(tb);
+    }
+}
+
+void ParallelSearch::setTablebase(const Tablebase* table) {
+    tb = table;
+    for (auto& s : searchers) s->setTablebase(tb);
+}
+
+SearchResult ParallelSearch::search(const Position& pos, Player side, const SearchLimits& limits,
+                                    const SearchHistory* history) {
+    stopAll.store(false, memory_order_relaxed);
+    return run(pos, side, limits, history);
+}
+
+void ParallelSearch::start(const Position& pos, Player side, const SearchLimits& limits,
+                           const SearchHistory* history, function<void(const SearchResult&)> done) {
+    wait();
+    stopAll.store(false, memory_order_relaxed);
+    if (history) workerHistory = *history;
+    const SearchHistory* h = history ? &workerHistory : nullptr;
+    worker = thread([this, pos, side, limits, h, done] { done(run(pos, side, limits, h)); });
+}
+
+SearchResult ParallelSearch::run(const Position& pos, Player side, const SearchLimits& limits,
+                                 const SearchHistory* history) {
+    int n = threads();
+    tt.newSearch();   // once: the helpers do not age the shared table
+
+    vector<SearchResult> results(n);
+    vector<thread> helpers;
+    for (int i = 1; i < n; i++)
+        helpers.emplace_back([&, i] { results[i] = searchers[i]->search(pos, side, limits, history); });
+
+    results[0] = searchers[0]->search(pos, side, limits, history);
+
+    stopAll.store(true, memory_order_relaxed);
+    for (auto& t : helpers) t.join();
+
+    // Deepest completed iteration wins, the main thread on ties
+    SearchResult best = results[0];
+    uint64_t nodes = 0, tbHits = 0;
+    for (int i = 0; i < n; i++) {
+        nodes += results[i].nodes;
+        tbHits += results[i].tbHits;
+        if (results[i].hasMove && results[i].depth > best.depth) {
+            best.best = results[i].best;
+            best.score = results[i].score;
+            best.depth = results[i].depth;
+        }
+    }
+    best.nodes = nodes;
+    best.tbHits = tbHits;
+    return best;
+}
+
+/* ------------------ Scaling benchmark ------------------ */
+
+// Start position, then positions reached by fixed move choices
+static vector<Position> benchPositions() {
+    vector<Position> res;
+    Position pos;
+    initBoard(pos);
+    res.push_back(pos);
+
+    Player side = WHITE;
+    for (int ply = 0; ply < 24; ply++) {
+        MoveList moves;
+        allLegalMoves(pos, side, moves);
+        if (moves.empty()) break;
+        Undo undo;
+        makeMove(pos, moves[(ply * 7 + 3) % moves.size()], undo);
+        side = opponent(side);
+        if (ply % 12 == 11 && side == WHITE) res.push_back(pos);
+    }
+    return res;
+}
+
+int smpBenchCommand(int argc, char* argv[]) {
+    int maxThreads = (argc > 0) ? atoi(argv[0]) : (int)thread::hardware_concurrency();
+    int moveTime = (argc > 1) ? atoi(argv[1]) : 2000;
+    if (maxThreads < 1) maxThreads = 1;
+
+    vector<Position> positions = benchPositions();
+    TransTable tt(256);
+
+    printf("threads      nodes        nps  speedup  avg depth\n");
+    double baseNps = 0;
+    for (int t = 1; ; t = min(t * 2, maxThreads)) {
+        ParallelSearch search(tt, t);
+        uint64_t nodes = 0;
+        int depthSum = 0;
+        auto start = chrono::steady_clock::now();
+
+        for (const Position& pos : positions) {
+            tt.clear();
+            SearchLimits limits;
+            limits.moveTimeMs = moveTime;
+            SearchResult r = search.search(pos, WHITE, limits);
+            nodes += r.nodes;
+            depthSum += r.depth;
+        }
+        int64_t ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+        double nps = ms > 0 ? nodes * 1000.0 / ms : 0.0;
+        if (t == 1) baseNps = nps;
+        printf("%7d %10llu %10.0f %8.2f %10.1f\n", t, (unsigned long long)nodes, nps,
+            baseNps > 0 ? nps / baseNps : 0.0, depthSum / (double)positions.size());
+        fflush(stdout);
+
+        if (t == maxThreads) break;
+    }
+    return 0;
+}
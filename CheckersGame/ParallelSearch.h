@@ -0,0 +1,67 @@
+#pragma once
+/*
+  Multi-threaded search (Lazy SMP).
+  ---------------------------------
+  Every thread runs the normal iterative-deepening search on the same root
+  and they all share one lock-free transposition table. The threads do not
+  talk to each other otherwise: the results one thread stores cut off or
+  reorder the others' trees. Odd helper threads start one ply deeper so
+  the workers spread over several depths.
+
+  The calling thread runs searcher 0; when it finishes (deadline, depth
+  limit or stop()) all helpers are stopped and the deepest completed result
+  is returned. start() does the same on a thread of its own, so the caller
+  stays free to read commands and stop() the search.
+*/
+
+#include "Search.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class ParallelSearch {
+public:
+    explicit ParallelSearch(TransTable& table, int threads = 1);
+    ~ParallelSearch() { wait(); }
+
+    void setThreads(int n);
+    void setTablebase(const Tablebase* table);
+    int threads() const { return (int)searchers.size(); }
+
+    SearchResult search(const Position& pos, Player side, const SearchLimits& limits,
+                        const SearchHistory* history = nullptr);
+
+    /*
+      Search in the background and return at once; 'done' is called with the
+      result on the search thread. A stop() issued after start() returns is
+      never lost. One search at a time: wait() for the previous one first.
+    */
+    void start(const Position& pos, Player side, const SearchLimits& limits,
+               const SearchHistory* history, std::function<void(const SearchResult&)> done);
+
+    // Wait for a background search (and its callback) to finish
+    void wait() { if (worker.joinable()) worker.join(); }
+
+    // Stop a running search (safe to call from another thread)
+    void stop() { stopAll.store(true, std::memory_order_relaxed); }
+
+private:
+    SearchResult run(const Position& pos, Player side, const SearchLimits& limits,
+                     const SearchHistory* history);
+
+    TransTable& tt;
+    std::vector<std::unique_ptr<Searcher>> searchers;
+    std::atomic<bool> stopAll{ false };
+    const Tablebase* tb = nullptr;
+    std::thread worker;
+    SearchHistory workerHistory;   // copy for the background search
+};
+
+/*
+  "smpbench [maxThreads] [movetimeMs]": search a few fixed positions with
+  1, 2, 4 ... maxThreads threads and print how nodes per second scale.
+*/
+int smpBenchCommand(int argc, char* argv[]);
@@ -0,0 +1,251 @@
+/*
+  PDN game records (see Pdn.h).
+*/
+
+#include "Pdn.h"
+#include "Notation.h"
+
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+
+string PdnGame::tag(const string& name) const {
+    for (auto& t : tags)
+        if (t.first == name) return t.second;
+    return "";
+}
+
+void PdnGame::clear() {
+    tags.clear();
+    initBoard(start);
+    startSide = WHITE;
+    moves.clear();
+    result = "*";
+    error.clear();
+}
+
+const char* pdnResult(int winner) {
+    if (winner == WHITE) return "1-0";
+    if (winner == BLACK) return "0-1";
+    return "1/2-1/2";
+}
+
+static bool isResult(const string& t) {
+    return t == "1-0" || t == "0-1" || t == "1/2-1/2" || t == "*"
+        || t == "2-0" || t == "0-2" || t == "1-1";
+}
+
+/* ------------------ Writer ------------------ */
+
+void writePdnGame(FILE* out, const PdnGame& game) {
+    bool hasResult = false, hasFen = false;
+    for (auto& t : game.tags) {
+        fprintf(out, "[%s \"%s\"]\n", t.first.c_str(), t.second.c_str());
+        hasResult |= t.first == "Result";
+        hasFen |= t.first == "FEN";
+    }
+    if (!hasResult) fprintf(out, "[Result \"%s\"]\n", game.result.c_str());
+
+    Position initial;
+    initBoard(initial);
+    bool setUp = game.startSide != WHITE || game.start.white != initial.white
+        || game.start.black != initial.black || game.start.kings != initial.kings;
+    if (setUp && !hasFen) fprintf(out, "[FEN \"%s\"]\n", positionFen(game.start, game.startSide).c_str());
+    fputc('\n', out);
+
+    // Move text, wrapped before 80 columns ("1... " if the second player starts)
+    string line;
+    size_t first = (game.startSide == WHITE) ? 0 : 1;
+    for (size_t i = 0; i < game.moves.size(); i++) {
+        string word;
+        size_t ply = i + first;
+        if (ply % 2 == 0) word = to_string(ply / 2 + 1) + ". ";
+        else if (i == 0) word = "1... ";
+        word += pdnMoveName(game.moves[i]);
+        if (!line.empty() && line.size() + 1 + word.size() > 79) {
+            fprintf(out, "%s\n", line.c_str());
+            line.clear();
+        }
+        if (!line.empty()) line += ' ';
+        line += word;
+    }
+    if (!line.empty() && line.size() + 1 + game.result.size() > 79) {
+        fprintf(out, "%s\n", line.c_str());
+        line.clear();
+    }
+    if (!line.empty()) line += ' ';
+    fprintf(out, "%s%s\n\n", line.c_str(), game.result.c_str());
+}
+
+/* ------------------ Reader ------------------ */
+
+int PdnReader::peek() {
+    if (pos == len) {
+        len = fread(buf, 1, sizeof(buf), file);
+        pos = 0;
+        total += len;
+        if (len == 0) return EOF;
+    }
+    return (unsigned char)buf[pos];
+}
+
+int PdnReader::get() {
+    int c = peek();
+    if (c != EOF) pos++;
+    return c;
+}
+
+void PdnReader::skipUntil(char close) {
+    for (int c; (c = get()) != EOF && c != close; ) {}
+}
+
+// [Name "value"], the '[' already read
+void PdnReader::readTag(PdnGame& game) {
+    string name, value;
+    int c;
+    while ((c = get()) != EOF && c != ']' && c != '"')
+        if (!isspace(c)) name += (char)c;
+    if (c == '"') {
+        while ((c = get()) != EOF && c != '"') {
+            if (c == '\\' && peek() != EOF) c = get();
+            value += (char)c;
+        }
+        skipUntil(']');
+    }
+    if (name == "FEN" && !parseFen(value, game.start, game.startSide) && game.error.empty())
+        game.error = "bad FEN '" + value + "'";
+    game.tags.emplace_back(name, value);
+}
+
+static bool isDelimiter(int c) {
+    return c == EOF || isspace(c) || c == '[' || c == ']' || c == '{' || c == '}'
+        || c == '(' || c == ')' || c == ';';
+}
+
+string PdnReader::readToken() {
+    string t;
+    while (!isDelimiter(peek())) t += (char)get();
+    if (t.empty()) t += (char)get();   // a stray ']', '}' or ')'
+    return t;
+}
+
+// Play the move written as 'token', or record why it cannot be played
+bool PdnReader::playToken(const string& token, Position& board, Player& side, PdnGame& game) {
+    Move found;
+    MoveParse res = parsePdnMove(token, board, side, found);
+    if (res == MOVE_BAD) {
+        game.error = "bad move '" + token + "'";
+        return false;
+    }
+    if (res != MOVE_OK) {
+        game.error = string(res == MOVE_AMBIGUOUS ? "ambiguous" : "illegal") + " move '" + token
+            + "' at ply " + to_string(game.moves.size() + 1);
+        return false;
+    }
+
+    game.moves.push_back(found);
+    Undo undo;
+    makeMove(board, found, undo);
+    side = opponent(side);
+    return true;
+}
+
+bool PdnReader::next(PdnGame& game) {
+    game.clear();
+    Position board = {};
+    Player side = WHITE;
+    bool started = false, inMoves = false;
+
+    while (true) {
+        int c = peek();
+        if (c == EOF) return started;
+        if (isspace(c)) {
+            get();
+        }
+        else if (c == '[') {
+            if (inMoves) return true;   // tags of the next game: no result given
+            get();
+            readTag(game);
+            started = true;
+        }
+        else if (c == '{') {
+            get();
+            skipUntil('}');
+        }
+        else if (c == ';') {
+            skipUntil('\n');
+        }
+        else if (c == '(') {
+            // Variations may nest
+            get();
+            for (int depth = 1; depth > 0 && (c = get()) != EOF; ) {
+                if (c == '(') depth++;
+                else if (c == ')') depth--;
+                else if (c == '{') skipUntil('}');
+            }
+        }
+        else {
+            string token = readToken();
+            if (!inMoves) {
+                board = game.start;
+                side = game.startSide;
+            }
+            started = inMoves = true;
+            if (isResult(token)) {
+                game.result = token;
+                return true;
+            }
+
+            // Move numbers ("12." or "12..."), possibly glued to the move
+            size_t dot = token.rfind('.');
+            if (dot != string::npos) token.erase(0, dot + 1);
+            while (!token.empty() && (token.back() == '!' || token.back() == '?')) token.pop_back();
+            if (token.empty() || !game.error.empty()) continue;
+
+            playToken(token, board, side, game);
+        }
+    }
+}
+
+/* ------------------ Command line ------------------ */
+
+static int checkFiles(int argc, char* argv[]) {
+    uint64_t games = 0, bad = 0, moves = 0, bytes = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (int f = 0; f < argc; f++) {
+        FILE* in = fopen(argv[f], "rb");
+        if (!in) {
+            fprintf(stderr, "pdn: cannot open %s\n", argv[f]);
+            return 1;
+        }
+        PdnReader reader(in);
+        PdnGame game;
+        for (uint64_t g = 1; reader.next(game); g++) {
+            games++;
+            moves += game.moves.size();
+            if (!game.error.empty()) {
+                if (++bad <= 10)
+                    printf("%s: game %llu: %s\n", argv[f], (unsigned long long)g, game.error.c_str());
+            }
+        }
+        bytes += reader.bytesRead();
+        fclose(in);
+    }
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("games %llu  with errors %llu  moves %llu  %.1f MB in %.2fs (%.0f games/s, %.1f MB/s)\n",
+        (unsigned long long)games, (unsigned long long)bad, (unsigned long long)moves,
+        bytes / 1e6, secs, secs > 0 ? games / secs : 0.0, secs > 0 ? bytes / 1e6 / secs : 0.0);
+    return bad ? 2 : 0;
+}
+
+int pdnCommand(int argc, char* argv[]) {
+    string sub = (argc > 0) ? argv[0] : "";
+    if (sub == "check" && argc > 1) return checkFiles(argc - 1, argv + 1);
+
+    fprintf(stderr, "usage: pdn check FILE...\n");
+    return 1;
+}
@@ -0,0 +1,78 @@
+#pragma once
+/*
+  Game records in PDN (Portable Draughts Notation).
+  -------------------------------------------------
+  - Writer: tag pairs, then the numbered move text and the result.
+      [Event "selfplay"]
+      [Result "1-0"]
+      1. 11-15 23-19 2. 8-11 22-17 ... 1-0
+  - Reader: streams a file of any size game by game through a fixed
+    buffer, so an archive is never loaded at once. Every move is replayed
+    through the move generator: a game with an illegal or unreadable move
+    is reported with the reason and the reader carries on with the next.
+  - Moves are "from-to" or captures "fromxto" / "fromxAxBx..to" with the
+    standard square numbers (see Notation.h). Comments {..} and ;..,
+    variations (..) and move numbers are skipped.
+  - A [FEN "..."] tag sets up the start position (see Notation.h).
+  - Results: "1-0" means the side that moved first won, "0-1" the other
+    side, "1/2-1/2" a draw, "*" unknown.
+
+  Command line:
+    pdn check FILE...                   replay every game, report errors
+*/
+
+#include "Board.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct PdnGame {
+    std::vector<std::pair<std::string, std::string>> tags;
+    Position start;                // the standard start unless a FEN tag says otherwise
+    Player startSide;
+    std::vector<Move> moves;
+    std::string result = "*";
+    std::string error;             // empty if every move was legal
+
+    PdnGame() { clear(); }
+
+    // Value of a tag, "" if missing
+    std::string tag(const std::string& name) const;
+    void clear();
+};
+
+// Result string for a winner (0 = draw, otherwise a Player)
+const char* pdnResult(int winner);
+
+void writePdnGame(FILE* out, const PdnGame& game);
+
+class PdnReader {
+public:
+    explicit PdnReader(FILE* in) : file(in) {}
+
+    /*
+      Read the next game into 'game' (reusing its storage).
+      False at the end of the input.
+    */
+    bool next(PdnGame& game);
+
+    uint64_t bytesRead() const { return total; }
+
+private:
+    int peek();
+    int get();
+    void skipUntil(char close);
+    void readTag(PdnGame& game);
+    std::string readToken();
+    bool playToken(const std::string& token, Position& pos, Player& side, PdnGame& game);
+
+    FILE* file;
+    char buf[1 << 16];
+    size_t pos = 0, len = 0;
+    uint64_t total = 0;
+};
+
+int pdnCommand(int argc, char* argv[]);
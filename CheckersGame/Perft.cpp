@@ -0,0 +1,198 @@
+/*
+  Perft (see Perft.h).
+*/
+
+#include "Perft.h"
+#include "Notation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+/*
+  Built-in positions with their known node counts (depth 1, 2, ...).
+  The start position matches the published American checkers perft
+  numbers; the others were taken from random games and checked against
+  an independent square-by-square implementation of the rules.
+*/
+struct PerftCase {
+    const char* name;
+    uint32_t white, black, kings;
+    Player side;
+    uint64_t counts[12];   // 0 terminated
+};
+
+static const PerftCase PERFT_SUITE[] = {
+    { "start", 0x00000FFF, 0xFFF00000, 0x00000000, WHITE,
+      { 7, 49, 302, 1469, 7361, 36768, 179740, 845931, 3963680, 18391564, 85242128 } },
+    { "kings-midgame", 0x04001908, 0x33500021, 0x00000021, BLACK,
+      { 8, 43, 293, 1413, 9141, 44288, 282003, 1365825, 8832123 } },
+    { "forced-capture", 0x01400120, 0x0C800880, 0x00000080, WHITE,
+      { 1, 5, 30, 162, 989, 5333, 34369, 177647, 1168385 } },
+    { "five-kings", 0x82000000, 0x0100000D, 0x8200000D, BLACK,
+      { 7, 37, 246, 1209, 9166, 45636, 360584, 2054525, 16902059 } },
+    { "open-midgame", 0x802011C9, 0x60108000, 0x80000000, WHITE,
+      { 12, 58, 298, 1018, 5451, 18865, 102042, 367087, 1978824 } },
+    { "multi-jump", 0x020A0309, 0xA8000040, 0x02000040, BLACK,
+      { 3, 14, 44, 192, 699, 3082, 12415, 55655, 227496 } },
+    { "king-jumps", 0x01010923, 0xB6820008, 0x00000008, BLACK,
+      { 2, 9, 72, 346, 2466, 10929, 69258, 295739, 1801815 } },
+};
+
+// The side to move alternates at compile time: no dispatch below the root
+template<Player PL>
+static uint64_t perftFor(Position& pos, int depth) {
+    MoveList moves;
+    allLegalMoves<PL>(pos, moves);
+
+    // Bulk counting: the last ply only needs the number of moves
+    if (depth == 1) return (uint64_t)moves.size();
+
+    uint64_t nodes = 0;
+    for (const Move& m : moves) {
+        Undo undo;
+        makeMove<PL>(pos, m, undo);
+        nodes += perftFor<opponent(PL)>(pos, depth - 1);
+        unmakeMove<PL>(pos, m, undo);
+    }
+    return nodes;
+}
+
+uint64_t perft(Position& pos, Player side, int depth) {
+    if (depth == 0) return 1;
+    return (side == WHITE) ? perftFor<WHITE>(pos, depth) : perftFor<BLACK>(pos, depth);
+}
+
+/* ------------------ Command line ------------------ */
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static Position casePosition(const PerftCase& pc) {
+    Position pos = { pc.white, pc.black, pc.kings, 0 };
+    refreshKey(pos);
+    return pos;
+}
+
+static const PerftCase* findCase(const char* name) {
+    for (const PerftCase& pc : PERFT_SUITE)
+        if (name == string(pc.name)) return &pc;
+    fprintf(stderr, "Unknown position '%s' (try: perft list)\n", name);
+    return nullptr;
+}
+
+static int runCounts(const PerftCase& pc, int depth) {
+    Position pos = casePosition(pc);
+    for (int d = 1; d <= depth; d++) {
+        auto start = chrono::steady_clock::now();
+        uint64_t nodes = perft(pos, pc.side, d);
+        double s = secondsSince(start);
+        printf("depth %2d  nodes %12llu  time %8.3fs  %6.1f Mnodes/s\n", d,
+            (unsigned long long)nodes, s, s > 0 ? nodes / s / 1e6 : 0.0);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+static int runDivide(const PerftCase& pc, int depth) {
+    Position pos = casePosition(pc);
+    MoveList moves;
+    allLegalMoves(pos, pc.side, moves);
+
+    auto start = chrono::steady_clock::now();
+    uint64_t total = 0;
+    for (const Move& m : moves) {
+        Undo undo;
+        makeMove(pos, m, undo);
+        uint64_t n = perft(pos, opponent(pc.side), depth - 1);
+        unmakeMove(pos, m, undo);
+        total += n;
+        printf("%-24s %llu\n", moveName(m).c_str(), (unsigned long long)n);
+    }
+    double s = secondsSince(start);
+    printf("\nmoves %d  nodes %llu  time %.3fs  %.1f Mnodes/s\n", moves.size(),
+        (unsigned long long)total, s, s > 0 ? total / s / 1e6 : 0.0);
+    return 0;
+}
+
+// Check every known count up to maxDepth; non-zero exit status on failure
+static int runSuite(int maxDepth) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (const PerftCase& pc : PERFT_SUITE) {
+        Position pos = casePosition(pc);
+        int before = failures;
+        for (int d = 1; d <= maxDepth && d <= 12 && pc.counts[d - 1]; d++) {
+            uint64_t nodes = perft(pos, pc.side, d);
+            totalNodes += nodes;
+            if (nodes != pc.counts[d - 1]) {
+                printf("FAIL %-16s depth %2d: got %llu, expected %llu\n", pc.name, d,
+                    (unsigned long long)nodes, (unsigned long long)pc.counts[d - 1]);
+                failures++;
+            }
+        }
+        printf("%-16s %s\n", pc.name, failures == before ? "ok" : "FAILED");
+    }
+
+    double s = secondsSince(start);
+    printf("\n%s: %llu nodes in %.3fs (%.1f Mnodes/s)\n", failures ? "FAILED" : "PASSED",
+        (unsigned long long)totalNodes, s, s > 0 ? totalNodes / s / 1e6 : 0.0);
+    return failures ? 1 : 0;
+}
+
+int perftCommand(int argc, char* argv[]) {
+    if (argc < 1) {
+        fprintf(stderr, "usage: perft <depth> [position|FEN] | perft divide <depth> [position|FEN] | perft test [maxDepth] | perft list\n");
+        return 1;
+    }
+
+    string sub = argv[0];
+    if (sub == "list") {
+        for (const PerftCase& pc : PERFT_SUITE) printf("%s\n", pc.name);
+        return 0;
+    }
+    if (sub == "test") return runSuite(argc > 1 ? atoi(argv[1]) : 8);
+
+    bool divide = (sub == "divide");
+    if (divide) {
+        argc--;
+        argv++;
+        if (argc < 1) {
+            fprintf(stderr, "usage: perft divide <depth> [position|FEN]\n");
+            return 1;
+        }
+    }
+
+    int depth = atoi(argv[0]);
+    if (depth < 1) {
+        fprintf(stderr, "perft: depth must be at least 1\n");
+        return 1;
+    }
+
+    // A built-in position by name, or any position as FEN
+    const char* name = argc > 1 ? argv[1] : "start";
+    PerftCase fenCase = { "fen", 0, 0, 0, WHITE, {} };
+    const PerftCase* pc = &fenCase;
+    if (strchr(name, ':')) {
+        Position pos;
+        if (!parseFen(name, pos, fenCase.side)) {
+            fprintf(stderr, "perft: bad FEN '%s'\n", name);
+            return 1;
+        }
+        fenCase.white = pos.white;
+        fenCase.black = pos.black;
+        fenCase.kings = pos.kings;
+    }
+    else {
+        pc = findCase(name);
+    }
+    if (!pc) return 1;
+    return divide ? runDivide(*pc, depth) : runCounts(*pc, depth);
+}
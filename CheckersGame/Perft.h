@@ -0,0 +1,22 @@
+#pragma once
+/*
+  Perft: count the leaf nodes of the full move tree to a fixed depth.
+  -------------------------------------------------------------------
+  The counts only depend on the rules, so they catch any change in move
+  generation, and the time taken measures generator + make/unmake speed.
+  Every complete turn (a whole capture chain included) is one ply.
+
+  Command line:
+    perft <depth> [position|FEN]        counts for depth 1..N with nodes/s
+    perft divide <depth> [position|FEN] count below every root move
+    perft test [maxDepth]               check the built-in suite of known counts
+    perft list                          names of the built-in positions
+*/
+
+#include "Board.h"
+
+#include <cstdint>
+
+uint64_t perft(Position& pos, Player side, int depth);
+
+int perftCommand(int argc, char* argv[]);
@@ -0,0 +1,84 @@
+/*
+  Pondering (see Ponder.h).
+*/
+
+#include "Ponder.h"
+
+using namespace std;
+
+void Ponderer::start(const Game& game, const SearchLimits& limits) {
+    if (pondering || game.over()) return;
+
+    // The guess: the table's best move here, or the only legal one
+    const MoveList& legal = game.legalMoves();
+    TTEntry e;
+    guessed = false;
+    if (legal.size() == 1) {
+        guess = legal[0];
+        guessed = true;
+    }
+    else if (tt.probe(positionKey(game.position(), game.turn()), e) && e.move) {
+        for (const Move& m : legal) {
+            if (moveCode(m) == e.move) {
+                guess = m;
+                guessed = true;
+                break;
+            }
+        }
+    }
+
+    Game next = game;
+    if (guessed) {
+        next.play(guess);
+        if (next.over()) {   // nothing for the computer to think about after it
+            next = game;
+            guessed = false;
+        }
+    }
+
+    SearchLimits unlimited;
+    unlimited.maxDepth = limits.maxDepth;
+    unlimited.moveTimeMs = 0;   // until played() or stop()
+    SearchHistory recent;
+    next.searchHistory(recent);
+
+    hit = false;
+    pondering = true;
+    ai.start(next.position(), next.turn(), unlimited, &recent,
+             [this](const SearchResult& r) { result = r; });
+}
+
+void Ponderer::played(const Move& mv) {
+    if (!pondering) return;
+    bool wasGuess = guessed && moveCode(mv) == moveCode(guess);
+    stop();
+    hit = wasGuess;
+}
+
+void Ponderer::stop() {
+    if (!pondering) return;
+    ai.stop();
+    ai.wait();
+    pondering = false;
+    hit = false;
+}
+
+SearchResult Ponderer::search(const Game& game, const SearchLimits& limits) {
+    stop();   // pondering without played(): the position is a different one
+    lastHit = hit;
+    hit = false;
+
+    SearchHistory recent;
+    game.searchHistory(recent);
+    if (!lastHit) return ai.search(game.position(), game.turn(), limits, &recent);
+
+    // The ponder search counts as part of this move's thinking
+    bool deepEnough = result.depth >= limits.maxDepth;
+    bool longEnough = limits.moveTimeMs > 0 && result.timeMs >= limits.moveTimeMs;
+    if (deepEnough || longEnough) return result;
+
+    SearchLimits rest = limits;
+    if (rest.moveTimeMs > 0) rest.moveTimeMs -= (int)result.timeMs;
+    SearchResult sr = ai.search(game.position(), game.turn(), rest, &recent);
+    return (result.depth > sr.depth) ? result : sr;
+}
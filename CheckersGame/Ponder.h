@@ -0,0 +1,61 @@
+#pragma once
+/*
+  Pondering: thinking on the opponent's time.
+  -------------------------------------------
+  While the human thinks, the computer guesses the move it expects (the
+  best move the transposition table holds for the human's position, which
+  is the reply its own last search was planning for) and searches the
+  position after it on a background thread, without a deadline. Everything
+  it finds goes into the shared transposition table:
+  - ponder hit (the guess was played): the time already spent counts
+    towards the computer's move. If that covers the move time or the depth
+    limit, the answer comes at once; otherwise the search continues for
+    the rest of the time from the warm table.
+  - ponder miss: the normal search runs, and gets whatever of the pondered
+    tree transposes into its own.
+  Without a guess the human's own position is pondered, which warms the
+  table for every reply at once.
+*/
+
+#include "Game.h"
+#include "ParallelSearch.h"
+
+class Ponderer {
+public:
+    Ponderer(ParallelSearch& search, TransTable& table) : ai(search), tt(table) {}
+    ~Ponderer() { stop(); }
+
+    Ponderer(const Ponderer&) = delete;
+    Ponderer& operator=(const Ponderer&) = delete;
+
+    // Start pondering; 'game' has the opponent to move. Does nothing while pondering already.
+    void start(const Game& game, const SearchLimits& limits);
+
+    // The opponent played 'mv': stop pondering and remember whether it was the guess
+    void played(const Move& mv);
+
+    // Stop pondering and forget it
+    void stop();
+
+    /*
+      The computer's move in 'game' within 'limits', reusing the ponder
+      search after a hit.
+    */
+    SearchResult search(const Game& game, const SearchLimits& limits);
+
+    bool active() const { return pondering; }
+
+    // Did the last search() answer a ponder hit?
+    bool lastWasHit() const { return lastHit; }
+
+private:
+    ParallelSearch& ai;
+    TransTable& tt;
+
+    bool pondering = false;
+    bool guessed = false;   // pondering the position after 'guess' (else the opponent's own)
+    Move guess = {};
+    bool hit = false;       // played() saw the guess
+    bool lastHit = false;
+    SearchResult result;    // written on the search thread, read after ai.wait()
+};
@@ -0,0 +1,93 @@
+#pragma once
+/*
+  Slot pool.
+  ----------
+  Objects of one type kept in slabs and recycled through a free list, for
+  things the server creates and drops all the time (games, connections):
+  - release() keeps the object, including whatever capacity its strings
+    and vectors have grown to, for the next acquire(). Once the pool has
+    grown to the peak load, starting and finishing games never reaches
+    the global allocator.
+  - Objects never move. Each one is named by a handle (slot index plus a
+    generation) that goes stale when the slot is released, so a late
+    reference, e.g. a search finishing for a closed connection, is caught.
+  - Handles are never below 2^32, so small numbers stay free for other ids.
+  - Not thread-safe: the pool belongs to one thread.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+template <class T, size_t SLAB_SIZE = 256>
+class SlotPool {
+public:
+    typedef uint64_t Handle;
+
+    // A recycled object is in the state release() left it in
+    Handle acquire() {
+        if (freeSlots.empty()) grow();
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        Slot& s = slot(index);
+        s.live = true;
+        live++;
+        return (uint64_t)s.generation << 32 | index;
+    }
+
+    void release(Handle h) {
+        Slot* s = find(h);
+        if (!s) return;
+        s->live = false;
+        s->generation++;
+        live--;
+        freeSlots.push_back((uint32_t)h);
+    }
+
+    // nullptr if the handle is stale
+    T* get(Handle h) {
+        Slot* s = find(h);
+        return s ? &s->value : nullptr;
+    }
+
+    size_t size() const { return live; }
+
+    // Call f(handle, object) for every live object
+    template <class F>
+    void forEach(F f) {
+        for (uint32_t i = 0; i < slots; i++) {
+            Slot& s = slot(i);
+            if (s.live) f((uint64_t)s.generation << 32 | i, s.value);
+        }
+    }
+
+private:
+    struct Slot {
+        T value;
+        uint32_t generation = 1;
+        bool live = false;
+    };
+
+    Slot& slot(uint32_t index) { return slabs[index / SLAB_SIZE][index % SLAB_SIZE]; }
+
+    Slot* find(Handle h) {
+        uint32_t index = (uint32_t)h;
+        if (index >= slots) return nullptr;
+        Slot& s = slot(index);
+        return (s.live && s.generation == (uint32_t)(h >> 32)) ? &s : nullptr;
+    }
+
+    void grow() {
+        slabs.push_back(std::make_unique<Slot[]>(SLAB_SIZE));
+        freeSlots.reserve(slots + SLAB_SIZE);
+        for (size_t i = SLAB_SIZE; i-- > 0; )
+            freeSlots.push_back((uint32_t)(slots + i));
+        slots += SLAB_SIZE;
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    std::vector<uint32_t> freeSlots;
+    uint32_t slots = 0;
+    size_t live = 0;
+};
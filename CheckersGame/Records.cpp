@@ -0,0 +1,177 @@
+/*
+  Binary position records (see Records.h).
+*/
+
+#include "Records.h"
+#include "Eval.h"
+#include "Pdn.h"
+#include "Search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+static constexpr uint32_t RECORDS_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 16;
+
+Position PositionRecord::position() const {
+    Position pos = { white, black, kings, 0 };
+    refreshKey(pos);
+    return pos;
+}
+
+PositionRecord makeRecord(const Position& pos, Player side, int result, int eval) {
+    PositionRecord r;
+    r.white = pos.white;
+    r.black = pos.black;
+    r.kings = pos.kings;
+    r.side = (uint8_t)side;
+    r.result = (int8_t)result;
+    r.eval = (int16_t)max(-32767, min(32767, eval));
+    return r;
+}
+
+/* ------------------ Writer ------------------ */
+
+bool RecordWriter::open(const char* path) {
+    close();
+    file = fopen(path, "wb");
+    if (!file) return false;
+    buffer.reserve(BLOCK);
+    written = 0;
+    failed = false;
+
+    uint8_t head[HEADER_SIZE] = { 'C', 'K', 'P', 'R' };
+    memcpy(head + 4, &RECORDS_VERSION, 4);
+    failed = fwrite(head, 1, HEADER_SIZE, file) != HEADER_SIZE;
+    return !failed;
+}
+
+void RecordWriter::flush() {
+    if (file && !buffer.empty())
+        failed |= fwrite(buffer.data(), sizeof(PositionRecord), buffer.size(), file) != buffer.size();
+    written += buffer.size();
+    buffer.clear();
+}
+
+bool RecordWriter::close() {
+    if (!file) return !failed;
+    flush();
+    failed |= fclose(file) != 0;
+    file = nullptr;
+    return !failed;
+}
+
+/* ------------------ Reader ------------------ */
+
+bool RecordFile::open(const char* path) {
+    records = nullptr;
+    count = 0;
+    if (!file.open(path)) return false;
+
+    const uint8_t* base = file.data();
+    uint32_t version = 0;
+    if (file.size() >= HEADER_SIZE) memcpy(&version, base + 4, 4);
+    if (file.size() < HEADER_SIZE || memcmp(base, "CKPR", 4) != 0 || version != RECORDS_VERSION
+        || (file.size() - HEADER_SIZE) % sizeof(PositionRecord) != 0) {
+        file.close();
+        return false;
+    }
+    records = (const PositionRecord*)(base + HEADER_SIZE);
+    count = (file.size() - HEADER_SIZE) / sizeof(PositionRecord);
+    return true;
+}
+
+/* ------------------ Command line ------------------ */
+
+// Winner of a PDN result string: WHITE / BLACK, 0 = draw, -1 = unknown
+static int pdnWinner(const string& result) {
+    if (result == "1-0" || result == "2-0") return WHITE;
+    if (result == "0-1" || result == "0-2") return BLACK;
+    if (result == "1/2-1/2" || result == "1-1") return 0;
+    return -1;
+}
+
+static int fromPdn(const char* inPath, const char* outPath) {
+    FILE* in = fopen(inPath, "rb");
+    if (!in) {
+        fprintf(stderr, "records: cannot open %s\n", inPath);
+        return 1;
+    }
+    RecordWriter out;
+    if (!out.open(outPath)) {
+        fprintf(stderr, "records: cannot write %s\n", outPath);
+        fclose(in);
+        return 1;
+    }
+
+    PdnReader reader(in);
+    PdnGame game;
+    uint64_t games = 0, skipped = 0;
+    while (reader.next(game)) {
+        int winner = pdnWinner(game.result);
+        if (!game.error.empty() || winner < 0) {
+            skipped++;
+            continue;
+        }
+        games++;
+
+        Position pos = game.start;
+        Player side = game.startSide;
+        for (const Move& m : game.moves) {
+            int result = winner == 0 ? 0 : winner == side ? 1 : -1;
+            out.add(makeRecord(pos, side, result, evaluate(pos, side)));
+            Undo undo;
+            makeMove(pos, m, undo);
+            side = opponent(side);
+        }
+    }
+    fclose(in);
+
+    uint64_t n = out.count();
+    if (!out.close()) {
+        fprintf(stderr, "records: write error on %s\n", outPath);
+        return 1;
+    }
+    printf("%llu positions from %llu games (%llu skipped: errors or no result)\n",
+        (unsigned long long)n, (unsigned long long)games, (unsigned long long)skipped);
+    return 0;
+}
+
+static int info(const char* path) {
+    RecordFile file;
+    if (!file.open(path)) {
+        fprintf(stderr, "records: cannot open %s\n", path);
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    uint64_t results[3] = { 0, 0, 0 }, whiteToMove = 0;
+    int64_t evalSum = 0;
+    for (const PositionRecord& r : file) {
+        results[r.result > 0 ? 2 : r.result < 0 ? 0 : 1]++;
+        whiteToMove += r.side == WHITE;
+        evalSum += r.eval;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t n = file.size();
+    printf("records %zu  white to move %llu\n", n, (unsigned long long)whiteToMove);
+    printf("side to move won %llu  drew %llu  lost %llu  mean eval %.1f\n",
+        (unsigned long long)results[2], (unsigned long long)results[1], (unsigned long long)results[0],
+        n ? evalSum / (double)n : 0.0);
+    printf("scanned in %.3fs (%.0f records/s)\n", secs, secs > 0 ? n / secs : 0.0);
+    return 0;
+}
+
+int recordsCommand(int argc, char* argv[]) {
+    string sub = (argc > 0) ? argv[0] : "";
+    if (sub == "pdn" && argc > 2) return fromPdn(argv[1], argv[2]);
+    if (sub == "info" && argc > 1) return info(argv[1]);
+
+    fprintf(stderr, "usage: records pdn IN.pdn OUT | records info FILE\n");
+    return 1;
+}
@@ -0,0 +1,84 @@
+#pragma once
+/*
+  Binary position records for training data.
+  ------------------------------------------
+  One fixed-width 16-byte record per position:
+    white, black, kings   the three masks of the position
+    side                  player to move
+    result                game result for the side to move: 1, 0 or -1
+    eval                  score of the side to move (search score when an
+                          engine chose the move, static evaluation otherwise)
+
+  A file is a 16-byte header ("CKPR", uint32 version, 8 bytes reserved)
+  followed by the records, little-endian. RecordWriter buffers records
+  and writes them in large blocks; RecordFile maps a file and hands out
+  the records in place, so a loader iterates them without any copy or
+  parsing.
+
+  Command line:
+    records pdn IN.pdn OUT             every position of a PDN archive
+    records info FILE                  counts, results and read speed
+  (selfplay --records FILE writes the positions of its games)
+*/
+
+#include "Board.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+struct PositionRecord {
+    uint32_t white, black, kings;
+    uint8_t side;
+    int8_t result;
+    int16_t eval;
+
+    Position position() const;
+};
+static_assert(sizeof(PositionRecord) == 16, "position records are 16 bytes on disk");
+
+PositionRecord makeRecord(const Position& pos, Player side, int result, int eval);
+
+class RecordWriter {
+public:
+    ~RecordWriter() { close(); }
+
+    bool open(const char* path);
+    void add(const PositionRecord& r) {
+        buffer.push_back(r);
+        if (buffer.size() == BLOCK) flush();
+    }
+    // Flush and close; false if anything failed to write
+    bool close();
+
+    uint64_t count() const { return written + buffer.size(); }
+
+private:
+    static constexpr size_t BLOCK = 1 << 16;   // records per write (1 MB)
+
+    void flush();
+
+    FILE* file = nullptr;
+    std::vector<PositionRecord> buffer;
+    uint64_t written = 0;
+    bool failed = false;
+};
+
+class RecordFile {
+public:
+    // Map a file written by RecordWriter; false if missing or malformed
+    bool open(const char* path);
+
+    size_t size() const { return count; }
+    const PositionRecord& operator[](size_t i) const { return records[i]; }
+    const PositionRecord* begin() const { return records; }
+    const PositionRecord* end() const { return records + count; }
+
+private:
+    MappedFile file;
+    const PositionRecord* records = nullptr;
+    size_t count = 0;
+};
+
+int recordsCommand(int argc, char* argv[]);
@@ -0,0 +1,149 @@
+/*
+  Console renderer (see Render.h).
+
+  Frame layout (1-based terminal lines):
+    line 1            top border
+    line 2 + 2*r      board row r, cell c starts at column 4 + 5*c
+    line 3 + 2*r      border under row r
+    line 18           file letters
+    line 19...        status text
+*/
+
+#include "Render.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+
+using namespace std;
+
+static const char* const BORDER = "  +----+----+----+----+----+----+----+----+\n";
+static const char* const FILES = "    a    b    c    d    e    f    g    h\n";
+static constexpr int STATUS_LINE = 19;
+
+// Printable symbols for each piece, indexed by Piece (feel free to change)
+static const char* const PIECE_STR[] = { "    ", " WB ", " WK ", " BM ", " BK " };
+
+static void appendNumber(string& s, int n) {
+    if (n >= 10) appendNumber(s, n / 10);
+    s += char('0' + n % 10);
+}
+
+// ESC [ line ; col H
+static void moveCursor(string& s, int line, int col) {
+    s += "\x1b[";
+    appendNumber(s, line);
+    s += ';';
+    appendNumber(s, col);
+    s += 'H';
+}
+
+static Piece cellPiece(const Position& pos, int r, int c) {
+    return isDarkSquare(r, c) ? pieceAt(pos, squareIndex(r, c)) : EMPTY;
+}
+
+ConsoleRenderer::ConsoleRenderer() {
+    buf.reserve(8192);
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    ansi = GetConsoleMode(out, &mode)
+        && SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+}
+
+void ConsoleRenderer::fullFrame(const Position& pos) {
+    buf += BORDER;
+    for (int r = 0; r < 8; r++) {
+        buf += char('1' + r);
+        buf += " |";
+        for (int c = 0; c < 8; c++) {
+            buf += PIECE_STR[cellPiece(pos, r, c)];
+            buf += '|';
+        }
+        buf += '\n';
+        buf += BORDER;
+    }
+    buf += FILES;
+}
+
+void ConsoleRenderer::changedSquares(const Position& pos) {
+    for (int sq = 0; sq < 32; sq++) {
+        Piece p = pieceAt(pos, sq);
+        if (p == pieceAt(last, sq)) continue;
+        moveCursor(buf, 2 + 2 * sqRow(sq), 4 + 5 * sqCol(sq));
+        buf += PIECE_STR[p];
+    }
+    moveCursor(buf, STATUS_LINE, 1);
+}
+
+void ConsoleRenderer::draw(const Position& pos, const string& status) {
+#ifdef _WIN32
+    if (!ansi) {
+        HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (GetConsoleScreenBufferInfo(out, &info)) {
+            DWORD cells = info.dwSize.X * info.dwSize.Y, written;
+            COORD home = { 0, 0 };
+            FillConsoleOutputCharacterA(out, ' ', cells, home, &written);
+            SetConsoleCursorPosition(out, home);
+        }
+    }
+#endif
+    compose(pos, status);
+    flush();
+}
+
+const string& ConsoleRenderer::compose(const Position& pos, const string& status) {
+    buf.clear();
+
+    if (ansi) {
+        if (!hasLast) buf += "\x1b[2J";   // first frame: start from a blank screen
+        if (diff && hasLast) {
+            changedSquares(pos);
+        }
+        else {
+            buf += "\x1b[H";
+            fullFrame(pos);
+        }
+        // The cursor is at the start of the status: erase the old status first,
+        // so a shorter line never leaves the tail of a longer one
+        buf += "\x1b[J";
+        buf += status;
+    }
+    else {
+        fullFrame(pos);   // draw() has cleared the console
+        buf += status;
+    }
+
+    last = pos;
+    hasLast = true;
+    return buf;
+}
+
+// One write call for the whole frame
+void ConsoleRenderer::flush() {
+    const char* p = buf.data();
+    size_t left = buf.size();
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    while (left > 0) {
+        DWORD written = 0;
+        if (!WriteFile(out, p, (DWORD)left, &written, nullptr) || written == 0) break;
+        p += written;
+        left -= written;
+    }
+#else
+    while (left > 0) {
+        ssize_t n = write(STDOUT_FILENO, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        p += n;
+        left -= (size_t)n;
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+/*
+  Console renderer.
+  -----------------
+  Builds a whole frame (board + status text) in one preallocated buffer and
+  hands it to the terminal with a single write:
+  - ANSI "cursor home" instead of clearing the screen, so nothing flickers
+    and no shell is spawned.
+  - Optional diff mode: only the squares that changed since the previous
+    frame are rewritten, plus the status text below the board.
+  - Windows: virtual-terminal processing is switched on; consoles without
+    it fall back to SetConsoleCursorPosition and full frames.
+*/
+
+#include "Board.h"
+
+#include <string>
+
+class ConsoleRenderer {
+public:
+    ConsoleRenderer();
+
+    // Redraw only changed squares (after the first full frame)
+    void setDiffMode(bool on) { diff = on; }
+
+    /*
+      Draw the board and, below it, 'status' (may span several lines). The
+      cursor is left at the end of the status text, ready for input.
+    */
+    void draw(const Position& pos, const std::string& status);
+
+    // The bytes draw() would write, without writing them (diff state advances too)
+    const std::string& compose(const Position& pos, const std::string& status);
+
+private:
+    void fullFrame(const Position& pos);
+    void changedSquares(const Position& pos);
+    void flush();
+
+    std::string buf;
+    Position last = {};
+    bool hasLast = false;
+    bool diff = false;
+    bool ansi = true;
+};
@@ -0,0 +1,44 @@
+/*
+  Draw rules (see Repetition.h).
+*/
+
+#include "Repetition.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void PositionHistory::reset(uint64_t key) {
+    keys.clear();
+    since.clear();
+    keys.push_back(key);
+    since.push_back(0);
+}
+
+void PositionHistory::push(uint64_t key, bool progress) {
+    int count = progress ? 0 : since.back() + 1;
+    keys.push_back(key);
+    since.push_back(count);
+}
+
+void PositionHistory::pop() {
+    if (keys.size() > 1) {
+        keys.pop_back();
+        since.pop_back();
+    }
+}
+
+int PositionHistory::repetitions() const {
+    int n = (int)keys.size() - 1;
+    int count = 1;
+    // Same side to move every second ply; nothing repeats across progress
+    for (int back = 2; back <= since[n]; back += 2)
+        if (keys[n - back] == keys[n]) count++;
+    return count;
+}
+
+void PositionHistory::searchHistory(SearchHistory& out) const {
+    int n = min((int)keys.size(), min(since.back(), NO_PROGRESS_PLIES) + 1);
+    copy(keys.end() - n, keys.end(), out.keys);
+    out.count = n;
+}
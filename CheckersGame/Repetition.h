@@ -0,0 +1,58 @@
+#pragma once
+/*
+  Draw rules.
+  -----------
+  - Threefold repetition: the same position, with the same side to move,
+    occurs for the third time.
+  - 40-move rule: 80 plies in a row (40 moves each) without a capture and
+    without a man move.
+  Captures and man moves can never be undone, so a position can only
+  repeat one seen since the last of them: that is all PositionHistory has
+  to look at, and it is all the search needs to know about the game.
+*/
+
+#include "Board.h"
+
+#include <cstdint>
+#include <vector>
+
+constexpr int NO_PROGRESS_PLIES = 80;
+
+// Does the move (in the position before it) reset the 40-move count?
+inline bool isProgress(const Position& before, const Move& m) {
+    return m.isCapture() || !(before.kings & (1u << m.from));
+}
+
+/*
+  The positions a search root can still repeat: the keys since the last
+  capture or man move, oldest first, ending with the root itself.
+*/
+struct SearchHistory {
+    uint64_t keys[NO_PROGRESS_PLIES + 1];
+    int count = 0;
+};
+
+// positionKey()s of a game, with the 40-move count of each
+class PositionHistory {
+public:
+    // Start over with the start position
+    void reset(uint64_t key);
+
+    // The position reached by a move; progress = isProgress(move)
+    void push(uint64_t key, bool progress);
+    void pop();
+
+    int pliesSinceProgress() const { return since.back(); }
+
+    // How often the current position has occurred, itself included
+    int repetitions() const;
+
+    bool repetitionDraw() const { return repetitions() >= 3; }
+    bool noProgressDraw() const { return pliesSinceProgress() >= NO_PROGRESS_PLIES; }
+
+    void searchHistory(SearchHistory& out) const;
+
+private:
+    std::vector<uint64_t> keys;
+    std::vector<int> since;   // plies since the last capture or man move
+};
@@ -0,0 +1,277 @@
+/*
+  Computer player: negamax alpha-beta search (see Search.h).
+*/
+
+#include "Search.h"
+#include "Eval.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace std;
+
+// Check the clock and stop flags once per this many nodes (well under a millisecond)
+static constexpr uint64_t TIME_CHECK_INTERVAL = 512;
+
+/* ------------------ Move ordering ------------------ */
+
+static bool sameMove(const Move& a, const Move& b) {
+    return a.from == b.from && a.to == b.to && a.captured == b.captured;
+}
+
+static int sideIndex(Player side) {
+    return side == WHITE ? 0 : 1;
+}
+
+/*
+  Give every move an ordering score:
+  - the best move stored in the transposition table
+  - captures: by number of pieces taken (all moves are captures then)
+  - quiet moves: killers first, then history counts
+*/
+void Searcher::orderMoves(MoveList& moves, Player side, int ply, uint16_t ttMove, int* scores) const {
+    for (int i = 0; i < moves.size(); i++) {
+        const Move& m = moves[i];
+        if (ttMove && moveCode(m) == ttMove)
+            scores[i] = 2000000;
+        else if (m.isCapture())
+            scores[i] = 1000000 + m.jumps;
+        else if (sameMove(m, killers[ply][0]))
+            scores[i] = 900000;
+        else if (sameMove(m, killers[ply][1]))
+            scores[i] = 800000;
+        else
+            scores[i] = history[sideIndex(side)][m.from][m.to];
+    }
+}
+
+// Move the best remaining entry to slot i (lazy selection sort)
+static void pickNext(MoveList& moves, int* scores, int i) {
+    int best = i;
+    for (int j = i + 1; j < moves.size(); j++)
+        if (scores[j] > scores[best]) best = j;
+    swap(moves[i], moves[best]);
+    swap(scores[i], scores[best]);
+}
+
+/* ------------------ Search ------------------ */
+
+// Win scores are stored relative to the node, not to the root
+static int scoreToTT(int score, int ply) {
+    if (score >= WIN_BOUND) return score + ply;
+    if (score <= -WIN_BOUND) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score >= WIN_BOUND) return score - ply;
+    if (score <= -WIN_BOUND) return score + ply;
+    return score;
+}
+
+/*
+  Tablebase result as a search score. Wins and losses count from the end
+  of the game like the ones the search finds itself.
+*/
+static int tablebaseScore(TbResult r, int plies, int ply) {
+    if (r == TB_DRAW) return 0;
+    int score = WIN_SCORE - ply - plies;
+    return (r == TB_WIN) ? score : -score;
+}
+
+bool Searcher::outOfTime() {
+    if (stopFlag.load(memory_order_relaxed)) return true;
+    if (externalStop && externalStop->load(memory_order_relaxed)) return true;
+    return hasDeadline && chrono::steady_clock::now() >= deadline;
+}
+
+// Does the node at 'ply' repeat an earlier position of the line with the same side to move?
+bool Searcher::repeated(int ply) const {
+    const uint64_t* keys = lineKeys + lineBase + ply;
+    // A repetition needs both sides to move away and back: four plies at least
+    for (int back = 4; back <= sinceProgress[ply]; back += 2)
+        if (keys[-back] == keys[0]) return true;
+    return false;
+}
+
+int Searcher::negamax(Position& pos, Player side, int depth, int alpha, int beta, int ply) {
+    if (aborted) return 0;
+    if (++nodes % TIME_CHECK_INTERVAL == 0 && outOfTime()) {
+        aborted = true;
+        return 0;
+    }
+
+    uint64_t key = positionKey(pos, side);
+    lineKeys[lineBase + ply] = key;
+    if (repeated(ply)) return 0;
+
+    // Quiescence nodes all behave like depth 0
+    if (depth < 0) depth = 0;
+
+    // Exact result from the tablebase
+    if (tb && popcount(pos.white | pos.black) <= tb->maxPieces()) {
+        int plies = 0;
+        TbResult r = tb->probe(pos, side, plies);
+        if (r != TB_UNKNOWN) {
+            tbHits++;
+            return tablebaseScore(r, plies, ply);
+        }
+    }
+
+    uint16_t ttMove = 0;
+    TTEntry tte;
+    STAT_INC(STAT_TT_PROBES);
+    if (tt.probe(key, tte)) {
+        STAT_INC(STAT_TT_HITS);
+        ttMove = tte.move;
+        if (tte.depth >= depth) {
+            int s = scoreFromTT(tte.score, ply);
+            if (tte.bound == BOUND_EXACT) return s;
+            if (tte.bound == BOUND_LOWER && s >= beta) return s;
+            if (tte.bound == BOUND_UPPER && s <= alpha) return s;
+        }
+    }
+
+    MoveList moves;
+    allLegalMoves(pos, side, moves);
+
+    // No move (or no pieces): the side to move has lost
+    if (moves.empty()) return -(WIN_SCORE - ply);
+    if (sinceProgress[ply] >= NO_PROGRESS_PLIES) return 0;
+
+    // Horizon: stop unless captures are pending (quiescence)
+    bool captures = moves[0].isCapture();
+    if ((depth == 0 && !captures) || ply >= MAX_PLY - 1)
+        return evaluate(pos, side, *evalW);
+
+    int scores[MAX_MOVES];
+    orderMoves(moves, side, ply, ttMove, scores);
+
+    int alphaOrig = alpha;
+    int best = -WIN_SCORE;
+    uint16_t bestMove = 0;
+    for (int i = 0; i < moves.size(); i++) {
+        pickNext(moves, scores, i);
+        const Move& m = moves[i];
+
+        sinceProgress[ply + 1] = isProgress(pos, m) ? 0 : sinceProgress[ply] + 1;
+        Undo undo;
+        makeMove(pos, m, undo);
+        int score = -negamax(pos, opponent(side), depth - 1, -beta, -alpha, ply + 1);
+        unmakeMove(pos, m, undo);
+
+        if (aborted) return 0;
+
+        if (score > best) {
+            best = score;
+            bestMove = moveCode(m);
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            // Remember quiet moves that refuted this line
+            if (!m.isCapture()) {
+                if (!sameMove(m, killers[ply][0])) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = m;
+                }
+                history[sideIndex(side)][m.from][m.to] += depth * depth;
+            }
+            break;
+        }
+    }
+
+    Bound bound = (best >= beta) ? BOUND_LOWER : (best > alphaOrig) ? BOUND_EXACT : BOUND_UPPER;
+    tt.store(key, depth, scoreToTT(best, ply), bound, bestMove);
+    return best;
+}
+
+/*
+  Iterative deepening driver.
+  The root moves are searched in the order of the previous iteration, so a
+  move that beats the previous best in an unfinished iteration is already
+  trustworthy and is kept.
+*/
+SearchResult Searcher::search(const Position& root, Player side, const SearchLimits& limits,
+                              const SearchHistory* hist) {
+    STAT_TIMER(TIMER_SEARCH);
+    STAT_INC(STAT_SEARCHES);
+    auto start = chrono::steady_clock::now();
+    stopFlag.store(false, memory_order_relaxed);
+    aborted = false;
+    if (!externalStop) tt.newSearch();   // ParallelSearch ages the table once for all threads
+    nodes = 0;
+    tbHits = 0;
+    hasDeadline = limits.moveTimeMs > 0;
+    deadline = start + chrono::milliseconds(limits.moveTimeMs);
+
+    for (auto& k : killers) k[0] = k[1] = Move{};
+    for (auto& h : history) for (auto& row : h) for (int& v : row) v /= 8;
+
+    SearchResult res;
+    MoveList moves;
+    allLegalMoves(root, side, moves);
+    if (moves.empty()) return res;
+
+    res.best = moves[0];
+    res.hasMove = true;
+
+    // Only one legal move: nothing to think about
+    if (moves.size() == 1) return res;
+
+    // The game so far, then the root
+    lineBase = 0;
+    if (hist && hist->count > 1) {
+        lineBase = hist->count - 1;
+        copy(hist->keys, hist->keys + lineBase, lineKeys);
+    }
+    lineKeys[lineBase] = positionKey(root, side);
+    sinceProgress[0] = lineBase;
+
+    Position pos = root;
+    int rootScores[MAX_MOVES];
+    TTEntry rootEntry;
+    uint16_t rootTTMove = tt.probe(positionKey(root, side), rootEntry) ? rootEntry.move : 0;
+    orderMoves(moves, side, 0, rootTTMove, rootScores);
+    for (int i = 0; i < moves.size(); i++) pickNext(moves, rootScores, i);
+
+    int firstDepth = 1 + (helper & 1);
+    for (int depth = firstDepth; depth <= limits.maxDepth && depth < MAX_PLY; depth++) {
+        STAT_TIMER(TIMER_SEARCH_ITERATION);
+        int alpha = -WIN_SCORE, beta = WIN_SCORE;
+        int bestIdx = -1;
+
+        for (int i = 0; i < moves.size(); i++) {
+            sinceProgress[1] = isProgress(pos, moves[i]) ? 0 : sinceProgress[0] + 1;
+            Undo undo;
+            makeMove(pos, moves[i], undo);
+            int score = -negamax(pos, opponent(side), depth - 1, -beta, -alpha, 1);
+            unmakeMove(pos, moves[i], undo);
+
+            if (aborted) break;
+            if (score > alpha) {
+                alpha = score;
+                bestIdx = i;
+            }
+        }
+
+        if (bestIdx >= 0) {
+            res.best = moves[bestIdx];
+            res.score = alpha;
+            // Best move first in the next iteration
+            rotate(moves.begin(), moves.begin() + bestIdx, moves.begin() + bestIdx + 1);
+        }
+        if (aborted) break;
+        res.depth = depth;
+
+        // A forced win or loss was found: deeper search cannot change it
+        if (alpha >= WIN_BOUND || alpha <= -WIN_BOUND) break;
+    }
+
+    res.nodes = nodes;
+    res.tbHits = tbHits;
+    STAT_ADD(STAT_SEARCH_NODES, nodes);
+    STAT_ADD(STAT_TB_HITS, tbHits);
+    res.timeMs = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    return res;
+}
@@ -0,0 +1,112 @@
+#pragma once
+/*
+  Computer player: negamax alpha-beta search.
+  -------------------------------------------
+  - Iterative deepening: depth 1, 2, 3 ... until the depth limit or the
+    deadline is reached.
+  - Transposition table: results are shared between move orders that reach
+    the same position; the stored best move is tried first.
+  - Move ordering: hash move, captures (longest chain first), then killer
+    moves, then the history heuristic.
+  - Quiescence: at the horizon the search keeps going while captures are
+    pending, since they are forced anyway.
+  - Endgame tablebase (optional): positions with few enough pieces are
+    scored exactly from the tablebase instead of being searched.
+  - Draws: a position that repeats one earlier in the line, or in the game
+    before the root (see Repetition.h), and a line reaching the 40-move
+    limit score 0, so repeated lines are cut short.
+  - Hard deadline: the clock is checked every few thousand nodes and the
+    search unwinds as soon as the budget is spent, returning the best move
+    found so far.
+*/
+
+#include "Board.h"
+#include "Eval.h"
+#include "Repetition.h"
+#include "Tablebase.h"
+#include "TransTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Longest line the search will ever look at
+constexpr int MAX_PLY = 128;
+
+// Score of a won position (minus the distance to the win). Wins lie in
+// [WIN_BOUND, WIN_SCORE], which covers a tablebase win at the deepest ply.
+constexpr int WIN_SCORE = 30000;
+constexpr int WIN_BOUND = WIN_SCORE - MAX_PLY - TB_MAX_DISTANCE;
+static_assert(MAX_EVAL_SCORE < WIN_BOUND / 2, "static scores must stay clear of the win scores");
+
+struct SearchLimits {
+    int maxDepth = 64;     // iterative deepening stops here
+    int moveTimeMs = 0;    // hard per-move deadline, 0 = no deadline
+};
+
+struct SearchResult {
+    Move best = {};
+    bool hasMove = false;  // false only if the side to move has no legal move
+    int score = 0;         // from the point of view of the side to move
+    int depth = 0;         // last fully completed iteration
+    uint64_t nodes = 0;
+    uint64_t tbHits = 0;   // nodes scored by the tablebase
+    int64_t timeMs = 0;
+};
+
+class Searcher {
+public:
+    explicit Searcher(TransTable& table) : tt(table) {}
+
+    // history: the game positions before the root (nullptr = none known)
+    SearchResult search(const Position& pos, Player side, const SearchLimits& limits,
+                        const SearchHistory* history = nullptr);
+
+    // Ask a running search to stop (safe to call from another thread)
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+
+    /*
+      Lazy SMP helpers (see ParallelSearch.h): also stop when *sharedStop is
+      set, and let odd helpers start one ply deeper so the threads spread
+      over different depths of the same tree. Helpers leave the table age
+      alone; the caller calls TransTable::newSearch() once per search.
+    */
+    void setHelper(const std::atomic<bool>* sharedStop, int helperId) {
+        externalStop = sharedStop;
+        helper = helperId;
+    }
+
+    // Probe this tablebase below the root (nullptr = none)
+    void setTablebase(const Tablebase* table) { tb = table; }
+
+    // Evaluate with these weights (nullptr = evalWeights()), e.g. to match two versions
+    void setEvalWeights(const EvalWeights* w) { evalW = w ? w : &evalWeights(); }
+
+private:
+    int negamax(Position& pos, Player side, int depth, int alpha, int beta, int ply);
+    void orderMoves(MoveList& moves, Player side, int ply, uint16_t ttMove, int* scores) const;
+    bool outOfTime();
+    bool repeated(int ply) const;
+
+    TransTable& tt;
+    const Tablebase* tb = nullptr;
+    const EvalWeights* evalW = &evalWeights();
+
+    std::atomic<bool> stopFlag{ false };
+    const std::atomic<bool>* externalStop = nullptr;
+    int helper = 0;
+    bool aborted = false;
+
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline = false;
+    uint64_t nodes = 0;
+    uint64_t tbHits = 0;
+
+    // Keys of the line from the game positions before the root to the current node
+    uint64_t lineKeys[NO_PROGRESS_PLIES + 1 + MAX_PLY];
+    int lineBase = 0;              // index of the root in lineKeys
+    int sinceProgress[MAX_PLY + 1];
+
+    Move killers[MAX_PLY][2] = {};
+    int history[2][32][32] = {};
+};
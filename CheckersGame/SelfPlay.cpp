@@ -0,0 +1,253 @@
+/*
+  Headless self-play (see SelfPlay.h).
+*/
+
+#include "SelfPlay.h"
+#include "Eval.h"
+#include "Pdn.h"
+#include "Records.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+const char* terminationName(Termination t) {
+    switch (t) {
+    case TERM_NO_MOVES:    return "no-moves";
+    case TERM_MAX_PLIES:   return "max-plies";
+    case TERM_REPETITION:  return "repetition";
+    case TERM_NO_PROGRESS: return "no-progress";
+    default:               return "?";
+    }
+}
+
+SelfPlayWorker::SelfPlayWorker(size_t hashMb, bool tablePerSide) : tt(hashMb), searcher(tt) {
+    if (tablePerSide) {
+        blackTT = make_unique<TransTable>(hashMb);
+        blackSearcher = make_unique<Searcher>(*blackTT);
+    }
+}
+
+void SelfPlayWorker::setTablebase(const Tablebase* tb) {
+    searcher.setTablebase(tb);
+    if (blackSearcher) blackSearcher->setTablebase(tb);
+}
+
+GameResult SelfPlayWorker::play(const SelfPlayOptions& opt, uint64_t seed, vector<Move>* moves,
+    vector<int>* scores) {
+    Position start;
+    initBoard(start);
+    return play(opt, start, WHITE, seed, moves, scores);
+}
+
+GameResult SelfPlayWorker::play(const SelfPlayOptions& opt, const Position& start, Player startSide,
+    uint64_t seed, vector<Move>* moves, vector<int>* scores) {
+    Rng rng(seed);
+    Position pos = start;
+    tt.clear();
+    if (blackTT) blackTT->clear();
+    if (moves) moves->clear();
+    if (scores) scores->clear();
+
+    GameResult res;
+    Player turn = startSide;
+    positions.reset(positionKey(pos, turn));
+    SearchHistory recent;
+
+    for (int ply = 0; ; ply++) {
+        MoveList legal;
+        allLegalMoves(pos, turn, legal);
+
+        // No pieces or no legal move: the side to move loses
+        if (legal.empty()) {
+            res.winner = opponent(turn);
+            res.reason = TERM_NO_MOVES;
+            res.plies = ply;
+            return res;
+        }
+        if (positions.repetitionDraw() || positions.noProgressDraw() || ply >= opt.maxPlies) {
+            res.winner = 0;
+            res.reason = positions.repetitionDraw() ? TERM_REPETITION
+                : positions.noProgressDraw() ? TERM_NO_PROGRESS : TERM_MAX_PLIES;
+            res.plies = ply;
+            return res;
+        }
+
+        const PlayerSpec& spec = (turn == WHITE) ? opt.white : opt.black;
+        Move mv;
+        bool searched = false;
+        int score = 0;
+        if (spec.random || ply < opt.randomPlies || legal.size() == 1)
+            mv = legal[rng.below(legal.size())];
+        else if (!book || !book->probe(pos, turn, mv)) {
+            Searcher& s = (turn == BLACK && blackSearcher) ? *blackSearcher : searcher;
+            s.setEvalWeights(spec.weights);
+            positions.searchHistory(recent);
+            SearchResult sr = s.search(pos, turn, spec.limits, &recent);
+            mv = sr.best;
+            score = sr.score;
+            searched = true;
+        }
+
+        if (moves) moves->push_back(mv);
+        if (scores) scores->push_back(searched ? score : evaluate(pos, turn, spec.weights ? *spec.weights : evalWeights()));
+
+        bool progress = isProgress(pos, mv);
+        Undo undo;
+        makeMove(pos, mv, undo);
+        turn = opponent(turn);
+        positions.push(positionKey(pos, turn), progress);
+    }
+}
+
+/* ------------------ Command line ------------------ */
+
+static bool parsePlayer(const string& s, PlayerSpec& spec) {
+    if (s == "random") spec.random = true;
+    else if (s == "engine") spec.random = false;
+    else return false;
+    return true;
+}
+
+int selfPlayCommand(int argc, char* argv[]) {
+    int games = 1000;
+    int jobs = max(1u, thread::hardware_concurrency());
+    size_t hashMb = 1;
+    uint64_t seed = 1;
+    const char* outPath = nullptr;
+    const char* pdnPath = nullptr;
+    const char* recordsPath = nullptr;
+    Tablebase tablebase;
+    OpeningBook book;
+
+    SelfPlayOptions opt;
+    opt.white.random = opt.black.random = true;
+    opt.white.limits.maxDepth = opt.black.limits.maxDepth = 4;
+    bool randomPliesSet = false;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        string val = (i + 1 < argc) ? argv[i + 1] : "";
+        bool ok = !val.empty();
+        if (arg == "--games" && ok) games = atoi(val.c_str());
+        else if (arg == "--white" && ok) ok = parsePlayer(val, opt.white);
+        else if (arg == "--black" && ok) ok = parsePlayer(val, opt.black);
+        else if (arg == "--depth" && ok) opt.white.limits.maxDepth = opt.black.limits.maxDepth = atoi(val.c_str());
+        else if (arg == "--movetime" && ok) opt.white.limits.moveTimeMs = opt.black.limits.moveTimeMs = atoi(val.c_str());
+        else if (arg == "--random-plies" && ok) { opt.randomPlies = atoi(val.c_str()); randomPliesSet = true; }
+        else if (arg == "--max-plies" && ok) opt.maxPlies = atoi(val.c_str());
+        else if (arg == "--jobs" && ok) jobs = max(1, atoi(val.c_str()));
+        else if (arg == "--hash" && ok) hashMb = (size_t)atoi(val.c_str());
+        else if (arg == "--tb" && ok) ok = tablebase.open(val.c_str());
+        else if (arg == "--book" && ok) ok = book.open(val.c_str());
+        else if (arg == "--eval" && ok) ok = loadEvalWeights(val.c_str());
+        else if (arg == "--seed" && ok) seed = strtoull(val.c_str(), nullptr, 10);
+        else if (arg == "--out" && ok) outPath = argv[i + 1];
+        else if (arg == "--pdn" && ok) pdnPath = argv[i + 1];
+        else if (arg == "--records" && ok) recordsPath = argv[i + 1];
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "selfplay: bad option '%s'\n", arg.c_str());
+            return 1;
+        }
+        i++;
+    }
+    bool anyEngine = !opt.white.random || !opt.black.random;
+
+    // Deterministic engines would replay one game over and over
+    if (anyEngine && !randomPliesSet) opt.randomPlies = 4;
+
+    FILE* pdn = pdnPath ? fopen(pdnPath, "wb") : nullptr;
+    if (pdnPath && !pdn) {
+        fprintf(stderr, "selfplay: cannot open %s\n", pdnPath);
+        return 1;
+    }
+    RecordWriter records;
+    if (recordsPath && !records.open(recordsPath)) {
+        fprintf(stderr, "selfplay: cannot open %s\n", recordsPath);
+        return 1;
+    }
+    mutex outputLock;
+
+    vector<GameResult> results(max(games, 0));
+    atomic<int> nextGame{ 0 };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int j = 0; j < jobs; j++) {
+        pool.emplace_back([&] {
+            SelfPlayWorker worker(hashMb);
+            if (tablebase.isOpen()) worker.setTablebase(&tablebase);
+            if (book.isOpen()) worker.setBook(&book);
+            PdnGame record;
+            vector<int> scores;
+            bool keep = pdn || recordsPath;
+            for (int g; (g = nextGame.fetch_add(1)) < games; ) {
+                const GameResult& r = results[g] = worker.play(opt, seed + (uint64_t)g,
+                    keep ? &record.moves : nullptr, keep ? &scores : nullptr);
+                if (!keep) continue;
+
+                // Games go out in the order they finish
+                lock_guard<mutex> lock(outputLock);
+                if (pdn) {
+                    // The side moving first is called Black in PDN
+                    record.result = pdnResult(r.winner);
+                    record.tags = { { "Event", "selfplay" }, { "Round", to_string(g + 1) },
+                                    { "Black", opt.white.random ? "random" : "engine" },
+                                    { "White", opt.black.random ? "random" : "engine" },
+                                    { "Result", record.result } };
+                    writePdnGame(pdn, record);
+                }
+                if (recordsPath) {
+                    Position pos;
+                    initBoard(pos);
+                    Player side = WHITE;
+                    for (size_t i = 0; i < record.moves.size(); i++) {
+                        int result = r.winner == 0 ? 0 : r.winner == side ? 1 : -1;
+                        records.add(makeRecord(pos, side, result, scores[i]));
+                        Undo undo;
+                        makeMove(pos, record.moves[i], undo);
+                        side = opponent(side);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    if (pdn) fclose(pdn);
+    if (recordsPath && !records.close()) {
+        fprintf(stderr, "selfplay: write error on %s\n", recordsPath);
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    FILE* out = outPath ? fopen(outPath, "wb") : stdout;
+    if (!out) {
+        fprintf(stderr, "selfplay: cannot open %s\n", outPath);
+        return 1;
+    }
+
+    int wins[3] = { 0, 0, 0 };
+    uint64_t plies = 0;
+    fprintf(out, "game,winner,plies,reason\n");
+    for (int g = 0; g < games; g++) {
+        const GameResult& r = results[g];
+        wins[r.winner]++;
+        plies += r.plies;
+        fprintf(out, "%d,%c,%d,%s\n", g, "DWB"[r.winner], r.plies, terminationName(r.reason));
+    }
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "games %d  white %d  black %d  draws %d  avg plies %.1f  time %.2fs  %.0f games/s (%d jobs)\n",
+        games, wins[WHITE], wins[BLACK], wins[0], games ? plies / (double)games : 0.0,
+        secs, secs > 0 ? games / secs : 0.0, jobs);
+    return 0;
+}
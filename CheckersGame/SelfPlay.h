@@ -0,0 +1,111 @@
+#pragma once
+/*
+  Headless self-play.
+  -------------------
+  Plays complete games engine-vs-engine, random-vs-random or mixed, with no
+  rendering at all, on several worker threads. Every game is written as one
+  compact CSV line:
+
+    game,winner,plies,reason
+    17,W,87,no-moves
+
+  winner is W, B or D (draw); reason says how the game ended: no-moves,
+  repetition, no-progress (40-move rule) or max-plies. A summary
+  with games per second goes to stderr. --pdn also writes every game as a
+  PDN record (see Pdn.h), --records every position as a binary training
+  record (see Records.h).
+
+  Command line:
+    selfplay [--games N] [--white engine|random] [--black engine|random]
+             [--depth D] [--movetime MS] [--random-plies N] [--max-plies N]
+             [--jobs N] [--hash MB] [--tb FILE] [--book FILE] [--eval FILE] [--seed S]
+             [--out FILE] [--pdn FILE] [--records FILE]
+*/
+
+#include "Board.h"
+#include "Book.h"
+#include "Repetition.h"
+#include "Search.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum Termination : uint8_t {
+    TERM_NO_MOVES = 0,    // side to move has no pieces or no legal move: it loses
+    TERM_MAX_PLIES = 1,   // ply limit reached: draw
+    TERM_REPETITION = 2,  // threefold repetition: draw
+    TERM_NO_PROGRESS = 3  // 40-move rule: draw
+};
+
+const char* terminationName(Termination t);
+
+struct GameResult {
+    int winner = 0;       // 0 = draw, otherwise a Player
+    int plies = 0;
+    Termination reason = TERM_NO_MOVES;
+};
+
+// How one side chooses its moves
+struct PlayerSpec {
+    bool random = false;  // uniformly random legal moves
+    SearchLimits limits;  // engine search limits otherwise
+    const EvalWeights* weights = nullptr;   // engine evaluation, nullptr = evalWeights()
+};
+
+struct SelfPlayOptions {
+    PlayerSpec white, black;
+    int randomPlies = 0;  // opening plies played at random (game variety)
+    int maxPlies = 400;   // hard cap so every game terminates
+};
+
+// Small, fast PRNG (xorshift64*) for move choices
+struct Rng {
+    uint64_t state;
+    explicit Rng(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+    int below(int n) { return (int)(next() % (uint64_t)n); }
+};
+
+/*
+  Plays games one after another on the calling thread. Owns its own small
+  transposition table and searcher, reused from game to game. With
+  tablePerSide BLACK gets a table and searcher of its own, so two different
+  engines never read each other's results.
+*/
+class SelfPlayWorker {
+public:
+    explicit SelfPlayWorker(size_t hashMb, bool tablePerSide = false);
+
+    void setTablebase(const Tablebase* tb);
+
+    // Engine players take their moves from this book while it has one
+    void setBook(const OpeningBook* b) { book = b; }
+
+    /*
+      Play one game from the start position. Optional outputs: every move
+      played, and for each the score of the side that played it (search
+      score, or the static evaluation for random and book moves).
+    */
+    GameResult play(const SelfPlayOptions& opt, uint64_t seed, std::vector<Move>* moves = nullptr,
+        std::vector<int>* scores = nullptr);
+
+    // The same from any position
+    GameResult play(const SelfPlayOptions& opt, const Position& start, Player startSide, uint64_t seed,
+        std::vector<Move>* moves = nullptr, std::vector<int>* scores = nullptr);
+
+private:
+    TransTable tt;
+    Searcher searcher;
+    std::unique_ptr<TransTable> blackTT;   // with tablePerSide only
+    std::unique_ptr<Searcher> blackSearcher;
+    const OpeningBook* book = nullptr;
+    PositionHistory positions;   // of the current game, for the draw rules
+};
+
+int selfPlayCommand(int argc, char* argv[]);
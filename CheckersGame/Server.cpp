@@ -0,0 +1,665 @@
+/*
+  Multi-game server (see Server.h).
+*/
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "Server.h"
+#include "Eval.h"
+#include "Game.h"
+#include "Input.h"
+#include "Notation.h"
+#include "Pdn.h"
+#include "Pool.h"
+#include "Search.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/* ------------------ Sockets ------------------ */
+
+#ifdef _WIN32
+typedef SOCKET socket_t;
+static const socket_t NO_SOCKET = INVALID_SOCKET;
+static void closeSocket(socket_t s) { closesocket(s); }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static bool setNonBlocking(socket_t s) {
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+}
+#else
+typedef int socket_t;
+static const socket_t NO_SOCKET = -1;
+static void closeSocket(socket_t s) { close(s); }
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+static bool setNonBlocking(socket_t s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+#endif
+
+// A client line longer than this is a protocol error
+static constexpr size_t MAX_LINE = 4096;
+
+// Event ids that are not connections (see SlotPool handles)
+static constexpr uint64_t LISTEN_ID = 0;
+static constexpr uint64_t WAKE_ID = 1;
+
+/* ------------------ Search pool ------------------ */
+
+struct SearchJob {
+    uint64_t conn;
+    uint32_t serial;      // Connection::serial when the job was queued
+    Position pos;
+    Player side;
+    SearchLimits limits;
+    SearchHistory history;   // positions since the last capture or man move
+};
+
+struct SearchDone {
+    uint64_t conn;
+    uint32_t serial;
+    Move move;
+    bool hasMove;
+};
+
+/*
+  Worker threads searching engine moves. Each owns a transposition table
+  and a Searcher for its whole life; finished moves are queued and the
+  event loop is woken. Both queues reuse their storage.
+*/
+class SearchPool {
+public:
+    SearchPool(int threads, size_t hashMb, const Tablebase* tb, function<void()> wake)
+        : wake(std::move(wake)) {
+        for (int i = 0; i < threads; i++)
+            workers.emplace_back([this, hashMb, tb] { work(hashMb, tb); });
+    }
+
+    ~SearchPool() {
+        {
+            lock_guard<mutex> lock(m);
+            quit = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    void submit(const SearchJob& job) {
+        {
+            lock_guard<mutex> lock(m);
+            if (head == jobs.size()) {
+                jobs.clear();
+                head = 0;
+            }
+            jobs.push_back(job);
+        }
+        cv.notify_one();
+    }
+
+    // Swap the finished searches into 'out' (its old contents are dropped)
+    void collect(vector<SearchDone>& out) {
+        lock_guard<mutex> lock(m);
+        out.swap(done);
+        done.clear();
+    }
+
+private:
+    void work(size_t hashMb, const Tablebase* tb) {
+        TransTable tt(hashMb);
+        Searcher searcher(tt);
+        searcher.setTablebase(tb);
+
+        while (true) {
+            SearchJob job;
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [this] { return quit || head < jobs.size(); });
+                if (quit) return;
+                job = jobs[head++];
+            }
+
+            SearchResult sr = searcher.search(job.pos, job.side, job.limits, &job.history);
+            {
+                lock_guard<mutex> lock(m);
+                done.push_back({ job.conn, job.serial, sr.best, sr.hasMove });
+            }
+            wake();
+        }
+    }
+
+    mutex m;
+    condition_variable cv;
+    vector<SearchJob> jobs;   // jobs[head..] are waiting
+    size_t head = 0;
+    vector<SearchDone> done;
+    bool quit = false;
+    function<void()> wake;
+    vector<thread> workers;
+};
+
+/* ------------------ Connections ------------------ */
+
+/*
+  Connections live in a SlotPool and are recycled: open() resets the
+  state but keeps the buffers and the game's move list allocated.
+*/
+struct Connection {
+    socket_t sock = NO_SOCKET;
+    uint64_t id = 0;         // pool handle
+    string in, out;
+    Game game;
+    bool client[3] = { false, true, false };   // sides the client plays (by Player)
+    SearchLimits limits;
+    uint32_t serial = 0;     // bumped by "new", so late engine moves of an old game are dropped
+    bool playing = false;    // "new" was sent
+    bool thinking = false;   // an engine move is being searched
+    bool closing = false;    // close once 'out' and any engine move are sent; reads stop
+    bool broken = false;     // the socket failed: close now
+    bool wantWrite = false;  // waiting for the socket to become writable
+
+    Connection() {
+        in.reserve(MAX_LINE);
+        out.reserve(MAX_LINE);
+    }
+
+    void open(socket_t s, uint64_t handle, const SearchLimits& defaults) {
+        sock = s;
+        id = handle;
+        in.clear();
+        out.clear();
+        game.reset();
+        client[WHITE] = true;    // as initialised: the client plays WHITE
+        client[BLACK] = false;
+        limits = defaults;
+        playing = thinking = closing = broken = wantWrite = false;
+    }
+};
+
+struct ServerOptions {
+    int port = 7531;
+    int threads = 0;         // 0 = one per core
+    size_t hashMb = 16;
+    SearchLimits limits;
+};
+
+class Server {
+public:
+    explicit Server(const ServerOptions& opt) : opt(opt) {}
+    ~Server();
+
+    bool start(const Tablebase* tb);
+    void run();
+
+private:
+    struct Event {
+        uint64_t id;
+        bool readable, writable, failed;
+    };
+
+    void waitEvents(vector<Event>& events);
+    void watch(Connection& c, bool add);
+    void wakeUp();
+
+    void acceptAll();
+    void readFrom(Connection& c);
+    void handleLine(Connection& c, string_view line);
+    void newGame(Connection& c, string_view args);
+    void playMove(Connection& c, string_view text);
+    void afterMove(Connection& c);
+    void finishSearches();
+
+    void send(Connection& c, const string& line);
+    void flush(Connection& c);
+    void settle(uint64_t id);
+
+    ServerOptions opt;
+    socket_t listener = NO_SOCKET;
+    unique_ptr<SearchPool> pool;
+    vector<SearchDone> finished;   // swapped with the pool's queue
+    SlotPool<Connection> conns;   // handles start at 2^32, above the fixed event ids
+#ifdef _WIN32
+    vector<WSAPOLLFD> pollFds;
+    vector<uint64_t> ids;   // event id of every pollFds entry
+#else
+    int epollFd = -1;
+    int wakeFd = -1;
+#endif
+};
+
+Server::~Server() {
+    pool.reset();
+    conns.forEach([](uint64_t, Connection& c) { closeSocket(c.sock); });
+    if (listener != NO_SOCKET) closeSocket(listener);
+#ifdef _WIN32
+    WSACleanup();
+#else
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+#endif
+}
+
+bool Server::start(const Tablebase* tb) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#else
+    signal(SIGPIPE, SIG_IGN);
+    epollFd = epoll_create1(0);
+    wakeFd = eventfd(0, EFD_NONBLOCK);
+    if (epollFd < 0 || wakeFd < 0) return false;
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+#endif
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == NO_SOCKET) return false;
+    int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)opt.port);
+    if (::bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0) return false;
+    if (::listen(listener, 512) != 0 || !setNonBlocking(listener)) return false;
+
+#ifndef _WIN32
+    ev.events = EPOLLIN;
+    ev.data.u64 = LISTEN_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listener, &ev);
+#endif
+
+    int threads = opt.threads;
+    if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+    pool = make_unique<SearchPool>(threads, opt.hashMb, tb, [this] { wakeUp(); });
+    fprintf(stderr, "server: listening on port %d, %d search threads\n", opt.port, threads);
+    return true;
+}
+
+/* ------------------ Event loop ------------------ */
+
+#ifdef _WIN32
+
+// No wake-up descriptor: the poll timeout picks up finished searches
+void Server::wakeUp() {}
+
+void Server::watch(Connection&, bool) {}
+
+void Server::waitEvents(vector<Event>& events) {
+    pollFds.clear();
+    pollFds.push_back({ listener, POLLRDNORM, 0 });
+    ids.clear();
+    ids.push_back(LISTEN_ID);
+    conns.forEach([&](uint64_t id, Connection& c) {
+        pollFds.push_back({ c.sock, (SHORT)((c.closing ? 0 : POLLRDNORM) | (c.wantWrite ? POLLWRNORM : 0)), 0 });
+        ids.push_back(id);
+    });
+
+    events.clear();
+    events.push_back({ WAKE_ID, true, false, false });
+    if (WSAPoll(pollFds.data(), (ULONG)pollFds.size(), 5) <= 0) return;
+    for (size_t i = 0; i < pollFds.size(); i++) {
+        SHORT r = pollFds[i].revents;
+        if (!r) continue;
+        events.push_back({ ids[i], (r & (POLLRDNORM | POLLHUP)) != 0, (r & POLLWRNORM) != 0,
+                           (r & (POLLERR | POLLNVAL)) != 0 });
+    }
+}
+
+#else
+
+void Server::wakeUp() {
+    uint64_t one = 1;
+    ssize_t n = write(wakeFd, &one, sizeof(one));
+    (void)n;
+}
+
+void Server::watch(Connection& c, bool add) {
+    epoll_event ev = {};
+    ev.events = (c.closing ? 0u : (uint32_t)EPOLLIN) | (c.wantWrite ? (uint32_t)EPOLLOUT : 0u);
+    ev.data.u64 = c.id;
+    epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, c.sock, &ev);
+}
+
+void Server::waitEvents(vector<Event>& events) {
+    epoll_event evs[256];
+    int n = epoll_wait(epollFd, evs, 256, -1);
+    events.clear();
+    for (int i = 0; i < n; i++) {
+        uint32_t e = evs[i].events;
+        events.push_back({ evs[i].data.u64, (e & (EPOLLIN | EPOLLHUP)) != 0, (e & EPOLLOUT) != 0,
+                           (e & EPOLLERR) != 0 });
+    }
+    for (auto& ev : events) {
+        if (ev.id != WAKE_ID) continue;
+        uint64_t count;
+        ssize_t r = read(wakeFd, &count, sizeof(count));
+        (void)r;
+    }
+}
+
+#endif
+
+void Server::run() {
+    vector<Event> events;
+    while (true) {
+        waitEvents(events);
+        for (const Event& ev : events) {
+            if (ev.id == LISTEN_ID) {
+                acceptAll();
+                continue;
+            }
+            if (ev.id == WAKE_ID) {
+                finishSearches();
+                continue;
+            }
+
+            Connection* c = conns.get(ev.id);
+            if (!c) continue;   // closed earlier in this batch
+            if (ev.failed) c->broken = true;
+            if (ev.writable) flush(*c);
+            // Reads are off while closing, so only a full hang-up gets here
+            if (ev.readable && c->closing) c->broken = true;
+            if (ev.readable && !c->broken) readFrom(*c);
+            settle(ev.id);
+        }
+    }
+}
+
+void Server::acceptAll() {
+    while (true) {
+        socket_t s = accept(listener, nullptr, nullptr);
+        if (s == NO_SOCKET) return;
+        int on = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+        if (!setNonBlocking(s)) {
+            closeSocket(s);
+            continue;
+        }
+
+        uint64_t id = conns.acquire();
+        Connection& c = *conns.get(id);
+        c.open(s, id, opt.limits);
+        watch(c, true);
+    }
+}
+
+void Server::readFrom(Connection& c) {
+    char buf[4096];
+    bool eof = false;
+    while (true) {
+        int n = (int)recv(c.sock, buf, sizeof(buf), 0);
+        if (n > 0) {
+            STAT_ADD(STAT_NET_BYTES_IN, n);
+            c.in.append(buf, (size_t)n);
+            continue;
+        }
+        if (n == 0) {
+            eof = true;   // the client sends no more, but may still read
+            break;
+        }
+        if (wouldBlock()) break;
+        c.broken = true;
+        return;
+    }
+
+    size_t pos = 0;
+    for (size_t nl; !c.closing && (nl = c.in.find('\n', pos)) != string::npos; pos = nl + 1) {
+        string_view line(c.in.data() + pos, nl - pos);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        handleLine(c, line);
+    }
+    c.in.erase(0, pos);
+
+    if (c.in.size() > MAX_LINE) {
+        send(c, "error line too long");
+        c.closing = true;
+    }
+    // Answer what came before the end of input, then close
+    if (eof) c.closing = true;
+    if (c.closing) watch(c, false);
+}
+
+/* ------------------ Protocol ------------------ */
+
+void Server::handleLine(Connection& c, string_view line) {
+    string_view rest = line;
+    string_view cmd = nextWord(rest);
+    if (cmd.empty()) return;
+
+    if (cmd == "new") {
+        newGame(c, rest);
+    }
+    else if (cmd == "move") {
+        playMove(c, nextWord(rest));
+    }
+    else if (cmd == "fen") {
+        send(c, "fen " + positionFen(c.game.position(), c.game.turn()));
+    }
+    else if (cmd == "legal") {
+        string reply = "legal";
+        for (const Move& m : c.game.legalMoves()) reply += " " + pdnMoveName(m);
+        send(c, reply);
+    }
+    else if (cmd == "stats") {
+        StatsFormat format = STATS_JSON;
+        string_view name = nextWord(rest);
+        if (!name.empty() && !parseStatsFormat(string(name), format)) send(c, "error unknown stats format");
+        else send(c, format == STATS_JSON ? "stats " + statsText(format) : statsText(format));
+    }
+    else if (cmd == "quit") {
+        c.closing = true;
+        c.thinking = false;   // drop the engine move being searched
+    }
+    else {
+        send(c, "error unknown command '" + string(cmd) + "'");
+    }
+}
+
+void Server::newGame(Connection& c, string_view args) {
+    bool client[3] = { false, true, false };
+    SearchLimits limits = opt.limits;
+    for (string_view word = nextWord(args); !word.empty(); word = nextWord(args)) {
+        if (word == "white" || word == "black" || word == "both" || word == "none") {
+            client[WHITE] = (word == "white" || word == "both");
+            client[BLACK] = (word == "black" || word == "both");
+        }
+        else if (word == "movetime" || word == "depth") {
+            int v = atoi(string(nextWord(args)).c_str());
+            if (v <= 0) {
+                send(c, "error " + string(word) + " needs a positive value");
+                return;
+            }
+            if (word == "movetime") limits.moveTimeMs = min(v, 60000);
+            else limits.maxDepth = min(v, MAX_PLY - 1);
+        }
+        else {
+            send(c, "error bad new argument '" + string(word) + "'");
+            return;
+        }
+    }
+
+    c.game.reset();
+    c.client[WHITE] = client[WHITE];
+    c.client[BLACK] = client[BLACK];
+    c.limits = limits;
+    c.serial++;
+    c.playing = true;
+    c.thinking = false;
+    send(c, "ok new");
+    afterMove(c);
+}
+
+void Server::playMove(Connection& c, string_view text) {
+    if (!c.playing) {
+        send(c, "error no game (send new)");
+        return;
+    }
+    if (c.game.over()) {
+        send(c, "error game over");
+        return;
+    }
+    if (c.thinking || !c.client[c.game.turn()]) {
+        send(c, "error not your turn");
+        return;
+    }
+
+    Move m;
+    MoveParse res = parsePdnMove(string(text), c.game.position(), c.game.turn(), m);
+    if (res != MOVE_OK) {
+        const char* why = (res == MOVE_BAD) ? "bad" : (res == MOVE_ILLEGAL) ? "illegal" : "ambiguous";
+        send(c, string("error ") + why + " move '" + string(text) + "'");
+        return;
+    }
+    c.game.play(m);
+    send(c, "ok " + pdnMoveName(m));
+    afterMove(c);
+}
+
+// Report the end of the game, or start the engine if it is to move
+void Server::afterMove(Connection& c) {
+    if (c.game.over()) {
+        send(c, string("result ") + pdnResult(c.game.winner()) + " " + gameStatusName(c.game.status()));
+        return;
+    }
+    if (c.client[c.game.turn()]) return;
+
+    c.thinking = true;
+    SearchJob job{ c.id, c.serial, c.game.position(), c.game.turn(), c.limits, {} };
+    c.game.searchHistory(job.history);
+    pool->submit(job);
+}
+
+void Server::finishSearches() {
+    pool->collect(finished);
+    for (const SearchDone& d : finished) {
+        Connection* cp = conns.get(d.conn);
+        if (!cp) continue;   // the client left meanwhile
+        Connection& c = *cp;
+        if (d.serial != c.serial || !c.thinking) continue;
+
+        c.thinking = false;
+        if (d.hasMove && c.game.play(d.move)) {
+            send(c, "move " + pdnMoveName(d.move));
+            afterMove(c);
+        }
+        settle(d.conn);
+    }
+}
+
+/* ------------------ Output ------------------ */
+
+void Server::send(Connection& c, const string& line) {
+    c.out += line;
+    c.out += '\n';
+}
+
+void Server::flush(Connection& c) {
+    size_t sent = 0;
+    while (sent < c.out.size()) {
+#ifdef MSG_NOSIGNAL
+        int n = (int)::send(c.sock, c.out.data() + sent, (int)(c.out.size() - sent), MSG_NOSIGNAL);
+#else
+        int n = (int)::send(c.sock, c.out.data() + sent, (int)(c.out.size() - sent), 0);
+#endif
+        if (n > 0) {
+            STAT_ADD(STAT_NET_BYTES_OUT, n);
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && wouldBlock()) break;
+        c.broken = true;
+        break;
+    }
+    c.out.erase(0, sent);
+}
+
+// Send what is queued, wait for writability if needed, close when done
+void Server::settle(uint64_t id) {
+    Connection* cp = conns.get(id);
+    if (!cp) return;
+    Connection& c = *cp;
+    if (!c.broken) flush(c);
+
+    if (c.broken || (c.closing && c.out.empty() && !c.thinking)) {
+        closeSocket(c.sock);   // also removes it from the epoll set
+        conns.release(id);
+        return;
+    }
+    bool want = !c.out.empty();
+    if (want != c.wantWrite) {
+        c.wantWrite = want;
+        watch(c, false);
+    }
+}
+
+/* ------------------ Command line ------------------ */
+
+int serverCommand(int argc, char* argv[]) {
+    ServerOptions opt;
+    opt.limits.moveTimeMs = 1000;
+    Tablebase tablebase;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        bool hasVal = i + 1 < argc;
+        if (arg == "--port" && hasVal) opt.port = atoi(argv[++i]);
+        else if (arg == "--threads" && hasVal) opt.threads = atoi(argv[++i]);
+        else if (arg == "--hash" && hasVal) opt.hashMb = (size_t)atoi(argv[++i]);
+        else if (arg == "--movetime" && hasVal) opt.limits.moveTimeMs = atoi(argv[++i]);
+        else if (arg == "--depth" && hasVal) opt.limits.maxDepth = atoi(argv[++i]);
+        else if (arg == "--eval" && hasVal) {
+            if (!loadEvalWeights(argv[++i])) return 1;
+        }
+        else if (arg == "--tb" && hasVal) {
+            if (!tablebase.open(argv[++i])) {
+                fprintf(stderr, "server: cannot open tablebase %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: server [--port N] [--threads N] [--hash MB] [--movetime MS] [--depth D] [--tb FILE] [--eval FILE]\n");
+            return 1;
+        }
+    }
+
+    Server server(opt);
+    if (!server.start(tablebase.isOpen() ? &tablebase : nullptr)) {
+        fprintf(stderr, "server: cannot listen on port %d\n", opt.port);
+        return 1;
+    }
+    server.run();
+    return 0;
+}
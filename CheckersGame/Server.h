@@ -0,0 +1,39 @@
+#pragma once
+/*
+  Multi-game server.
+  ------------------
+  Hosts any number of games in one process over plain TCP. Every
+  connection owns one Game at a time (see Game.h) and talks a line-based
+  protocol, so telnet / nc, a web gateway or a bot can all connect:
+
+    new [white|black|both|none] [movetime MS] [depth D]
+                         start a game; the client plays the given side(s)
+                         (default white), the server's engine the others
+                         -> ok new
+    move M               play a move in standard notation ("11-15", "22x15")
+                         -> ok M
+    fen                  -> fen FEN
+    legal                -> legal M M ...
+    stats [json|prometheus]
+                         -> stats {...}, or the Prometheus text up to
+                            "# EOF" (process-wide counters, see Stats.h)
+    quit                 close the connection
+
+  The server sends its own moves as "move M" as soon as they are found and
+  "result 1-0|0-1 <reason>" when a game ends. Bad commands get "error ...".
+  A client that closes its sending side (nc -N, a script) still gets the
+  replies to every line it sent, and the engine move being searched; then
+  the server closes the connection.
+
+  - One event-loop thread multiplexes all sockets (epoll on Linux, WSAPoll
+    on Windows) and owns all games, so they are never locked.
+  - Engine moves are searched by a small pool of worker threads, each with
+    its own transposition table; results come back to the event loop
+    through a queue and a wake-up descriptor.
+
+  Command line:
+    server [--port N (default 7531)] [--threads N] [--hash MB per thread]
+           [--movetime MS (default 1000)] [--depth D] [--tb FILE] [--eval FILE]
+*/
+
+int serverCommand(int argc, char* argv[]);
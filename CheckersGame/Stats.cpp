@@ -0,0 +1,179 @@
+/*
+  Counters and timers (see Stats.h).
+*/
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+struct StatInfo {
+    const char* name;
+    const char* help;
+};
+
+static const StatInfo COUNTER_INFO[STAT_COUNTERS] = {
+    { "movegen_calls",      "Calls of allLegalMoves" },
+    { "captures_generated", "Capture moves generated by allLegalMoves" },
+    { "quiets_generated",   "Simple moves generated by allLegalMoves" },
+    { "moves_made",         "Moves played by makeMove and applyMove" },
+    { "searches",           "Searches started (one per search thread)" },
+    { "search_nodes",       "Nodes visited by searches" },
+    { "tt_probes",          "Transposition table probes in the search" },
+    { "tt_hits",            "Transposition table probes that found the position" },
+    { "tb_hits",            "Endgame tablebase hits in the search" },
+    { "input_lines",        "Lines read from standard input" },
+    { "input_bytes",        "Bytes read from standard input" },
+    { "net_bytes_in",       "Bytes received by the server" },
+    { "net_bytes_out",      "Bytes sent by the server" },
+};
+
+static const StatInfo TIMER_INFO[STAT_TIMERS] = {
+    { "search",           "Whole searches" },
+    { "search_iteration", "Single iterative deepening iterations" },
+    { "input_wait",       "Time spent waiting for standard input" },
+};
+
+const char* statCounterName(int c) {
+    return (c >= 0 && c < STAT_COUNTERS) ? COUNTER_INFO[c].name : "?";
+}
+
+const char* statTimerName(int t) {
+    return (t >= 0 && t < STAT_TIMERS) ? TIMER_INFO[t].name : "?";
+}
+
+/* ------------------ Thread registry ------------------ */
+
+/*
+  The slots of running threads, and the totals of the threads that have
+  exited. Only registration, exit and dumps take the lock.
+*/
+struct StatsRegistry {
+    mutex m;
+    vector<ThreadStats*> live;
+    StatsSnapshot retired = {};
+};
+
+static StatsRegistry& registry() {
+    static StatsRegistry r;
+    return r;
+}
+
+static void addInto(StatsSnapshot& total, const ThreadStats& s) {
+    for (int c = 0; c < STAT_COUNTERS; c++)
+        total.counters[c] += s.counters[c].load(memory_order_relaxed);
+    for (int t = 0; t < STAT_TIMERS; t++) {
+        total.timerCount[t] += s.timerCount[t].load(memory_order_relaxed);
+        total.timerNs[t] += s.timerNs[t].load(memory_order_relaxed);
+        total.timerMaxNs[t] = max(total.timerMaxNs[t], s.timerMaxNs[t].load(memory_order_relaxed));
+    }
+}
+
+// Owns a thread's slots; folds them into the retired totals when the thread exits
+struct StatsHolder {
+    ThreadStats stats;
+
+    StatsHolder() {
+        StatsRegistry& r = registry();
+        lock_guard<mutex> lock(r.m);
+        r.live.push_back(&stats);
+    }
+    ~StatsHolder() {
+        StatsRegistry& r = registry();
+        lock_guard<mutex> lock(r.m);
+        addInto(r.retired, stats);
+        r.live.erase(find(r.live.begin(), r.live.end(), &stats));
+        threadStatsSlot = nullptr;
+    }
+};
+
+thread_local constinit ThreadStats* threadStatsSlot = nullptr;
+
+ThreadStats* registerStatsThread() {
+    static thread_local StatsHolder holder;
+    threadStatsSlot = &holder.stats;
+    return threadStatsSlot;
+}
+
+StatsSnapshot statsSnapshot() {
+    StatsRegistry& r = registry();
+    lock_guard<mutex> lock(r.m);
+    StatsSnapshot total = r.retired;
+    for (const ThreadStats* s : r.live) addInto(total, *s);
+    return total;
+}
+
+/* ------------------ Dumps ------------------ */
+
+bool parseStatsFormat(const string& name, StatsFormat& out) {
+    if (name == "json") out = STATS_JSON;
+    else if (name == "prometheus") out = STATS_PROMETHEUS;
+    else return false;
+    return true;
+}
+
+static double seconds(uint64_t ns) {
+    return ns / 1e9;
+}
+
+// One line: {"counters":{...},"timers":{"name":{"count":N,"total_s":S,"max_s":S},...},"tt_hit_rate":R}
+static string statsJson(const StatsSnapshot& s) {
+    string out = "{\"counters\":{";
+    char buf[160];
+    for (int c = 0; c < STAT_COUNTERS; c++) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":%llu", c ? "," : "", COUNTER_INFO[c].name,
+            (unsigned long long)s.counters[c]);
+        out += buf;
+    }
+    out += "},\"timers\":{";
+    for (int t = 0; t < STAT_TIMERS; t++) {
+        snprintf(buf, sizeof(buf), "%s\"%s\":{\"count\":%llu,\"total_s\":%.6f,\"max_s\":%.6f}",
+            t ? "," : "", TIMER_INFO[t].name, (unsigned long long)s.timerCount[t],
+            seconds(s.timerNs[t]), seconds(s.timerMaxNs[t]));
+        out += buf;
+    }
+    uint64_t probes = s.counters[STAT_TT_PROBES];
+    snprintf(buf, sizeof(buf), "},\"tt_hit_rate\":%.4f}",
+        probes ? (double)s.counters[STAT_TT_HITS] / probes : 0.0);
+    out += buf;
+    return out;
+}
+
+// Prometheus / OpenMetrics text: counters, a summary per timer and its maximum
+static string statsPrometheus(const StatsSnapshot& s) {
+    string out;
+    char buf[256];
+    for (int c = 0; c < STAT_COUNTERS; c++) {
+        const StatInfo& info = COUNTER_INFO[c];
+        snprintf(buf, sizeof(buf), "# HELP checkers_%s %s.\n# TYPE checkers_%s counter\ncheckers_%s_total %llu\n",
+            info.name, info.help, info.name, info.name, (unsigned long long)s.counters[c]);
+        out += buf;
+    }
+    for (int t = 0; t < STAT_TIMERS; t++) {
+        const StatInfo& info = TIMER_INFO[t];
+        snprintf(buf, sizeof(buf), "# HELP checkers_%s_seconds %s.\n# TYPE checkers_%s_seconds summary\n"
+            "checkers_%s_seconds_count %llu\ncheckers_%s_seconds_sum %.6f\n",
+            info.name, info.help, info.name, info.name, (unsigned long long)s.timerCount[t],
+            info.name, seconds(s.timerNs[t]));
+        out += buf;
+        snprintf(buf, sizeof(buf), "# HELP checkers_%s_max_seconds Longest of checkers_%s_seconds.\n"
+            "# TYPE checkers_%s_max_seconds gauge\ncheckers_%s_max_seconds %.6f\n",
+            info.name, info.name, info.name, info.name, seconds(s.timerMaxNs[t]));
+        out += buf;
+    }
+    out += "# EOF";
+    return out;
+}
+
+string statsText(StatsFormat format) {
+    StatsSnapshot s = statsSnapshot();
+    return (format == STATS_JSON) ? statsJson(s) : statsPrometheus(s);
+}
+
+void writeStats(FILE* out, StatsFormat format) {
+    fputs(statsText(format).c_str(), out);
+    fputc('\n', out);
+}
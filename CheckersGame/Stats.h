@@ -0,0 +1,139 @@
+#pragma once
+/*
+  Counters and timers.
+  --------------------
+  Cheap always-on statistics for the hot paths (move generation, making
+  moves, search, transposition table, I/O):
+  - counters: how often something happened (or how many of it)
+  - timers: how many times a section ran, its total and its longest time
+  Every thread bumps its own slots, so a hook costs one thread-local load
+  and an increment, with no locking or shared cache lines. A dump adds up
+  all threads, including the ones that have exited since.
+
+  Build with CHECKERS_NO_STATS defined to compile every hook out; the dumps
+  then report zeros.
+
+  Dumps: one line of JSON or the Prometheus / OpenMetrics text format
+  (ending with "# EOF"). The engine ("stats" command) and the server
+  ("stats" request) print them on demand.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+enum StatCounter {
+    STAT_MOVEGEN_CALLS = 0,   // allLegalMoves()
+    STAT_CAPTURES_GENERATED,  // capture moves listed by allLegalMoves()
+    STAT_QUIETS_GENERATED,    // simple moves listed by allLegalMoves()
+    STAT_MOVES_MADE,          // makeMove() and applyMove()
+    STAT_SEARCHES,
+    STAT_SEARCH_NODES,
+    STAT_TT_PROBES,
+    STAT_TT_HITS,
+    STAT_TB_HITS,
+    STAT_INPUT_LINES,         // lines read by LineReader
+    STAT_INPUT_BYTES,
+    STAT_NET_BYTES_IN,        // server sockets
+    STAT_NET_BYTES_OUT,
+    STAT_COUNTERS
+};
+
+enum StatTimer {
+    TIMER_SEARCH = 0,         // one whole search
+    TIMER_SEARCH_ITERATION,   // one depth of iterative deepening
+    TIMER_INPUT_WAIT,         // LineReader waiting for input
+    STAT_TIMERS
+};
+
+const char* statCounterName(int c);
+const char* statTimerName(int t);
+
+// One thread's slots. Only the owner writes them; dumps read them racily but safely.
+struct ThreadStats {
+    std::atomic<uint64_t> counters[STAT_COUNTERS] = {};
+    std::atomic<uint64_t> timerCount[STAT_TIMERS] = {};
+    std::atomic<uint64_t> timerNs[STAT_TIMERS] = {};
+    std::atomic<uint64_t> timerMaxNs[STAT_TIMERS] = {};
+};
+
+// Totals over all threads
+struct StatsSnapshot {
+    uint64_t counters[STAT_COUNTERS];
+    uint64_t timerCount[STAT_TIMERS];
+    uint64_t timerNs[STAT_TIMERS];
+    uint64_t timerMaxNs[STAT_TIMERS];
+};
+
+StatsSnapshot statsSnapshot();
+
+enum StatsFormat {
+    STATS_JSON,
+    STATS_PROMETHEUS
+};
+
+// Parse "json" / "prometheus"; false if unknown
+bool parseStatsFormat(const std::string& name, StatsFormat& out);
+
+// The dump without a final newline; writeStats() adds one
+std::string statsText(StatsFormat format);
+void writeStats(FILE* out, StatsFormat format);
+
+/* ------------------ Hooks ------------------ */
+
+// The calling thread's slots (registered on first use)
+ThreadStats* registerStatsThread();
+extern thread_local constinit ThreadStats* threadStatsSlot;
+
+inline ThreadStats& threadStats() {
+    ThreadStats* s = threadStatsSlot;
+    return s ? *s : *registerStatsThread();
+}
+
+// Owner-only update: a plain load and store, no atomic read-modify-write
+inline void bumpStat(std::atomic<uint64_t>& slot, uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline void addStat(StatCounter c, uint64_t n = 1) {
+    bumpStat(threadStats().counters[c], n);
+}
+
+inline void recordStatTime(StatTimer t, uint64_t ns) {
+    ThreadStats& s = threadStats();
+    bumpStat(s.timerCount[t], 1);
+    bumpStat(s.timerNs[t], ns);
+    if (ns > s.timerMaxNs[t].load(std::memory_order_relaxed))
+        s.timerMaxNs[t].store(ns, std::memory_order_relaxed);
+}
+
+// Times its own lifetime
+class ScopedStatTimer {
+public:
+    explicit ScopedStatTimer(StatTimer t) : timer(t), start(std::chrono::steady_clock::now()) {}
+    ~ScopedStatTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        recordStatTime(timer, (uint64_t)ns.count());
+    }
+    ScopedStatTimer(const ScopedStatTimer&) = delete;
+    ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+private:
+    StatTimer timer;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define STAT_CONCAT2(a, b) a##b
+#define STAT_CONCAT(a, b) STAT_CONCAT2(a, b)
+
+#ifdef CHECKERS_NO_STATS
+#define STAT_ADD(c, n) ((void)0)
+#define STAT_INC(c) ((void)0)
+#define STAT_TIMER(t) ((void)0)
+#else
+#define STAT_ADD(c, n) addStat(c, (uint64_t)(n))
+#define STAT_INC(c) addStat(c)
+#define STAT_TIMER(t) ScopedStatTimer STAT_CONCAT(statTimer_, __LINE__)(t)
+#endif
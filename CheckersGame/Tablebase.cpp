@@ -0,0 +1,513 @@
+/*
+  Endgame tablebase (see Tablebase.h).
+
+  File layout (little-endian):
+    header   "CKTB", uint32 version, uint32 maxPieces, uint32 sliceCount
+    entries  sliceCount x { uint8 wm, wk, bm, bk; uint32 0; uint64 offset; uint64 size }
+    data     the value bytes of every slice, each starting on a 64-byte boundary
+*/
+
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr uint32_t TB_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 16;
+static constexpr size_t ENTRY_SIZE = 24;
+
+// Value bytes: 0 = draw (or not solved yet), 1 + plies otherwise
+static constexpr uint8_t VALUE_DRAW = 0;
+static constexpr uint8_t VALUE_INVALID = 255;   // generator only: index is not a position
+
+// Men can never stand on their own crowning row
+static constexpr int MAN_SQUARES = 28;
+
+/* ------------------ Indexing ------------------ */
+
+struct Binomials {
+    uint64_t c[33][33] = {};
+    constexpr Binomials() {
+        for (int n = 0; n <= 32; n++) {
+            c[n][0] = 1;
+            for (int k = 1; k <= n; k++) c[n][k] = c[n - 1][k - 1] + (k < n ? c[n - 1][k] : 0);
+        }
+    }
+};
+static constexpr Binomials BINOM;
+
+// Material signature of one slice, from the point of view of the side to move
+struct Material {
+    int wm, wk, bm, bk;
+};
+
+static uint64_t sliceSize(const Material& m) {
+    int free = 32 - m.wm - m.bm;
+    return BINOM.c[MAN_SQUARES][m.wm] * BINOM.c[MAN_SQUARES][m.bm]
+        * BINOM.c[free][m.wk] * BINOM.c[free - m.wk][m.bk];
+}
+
+// Colex rank of a set of bits: sum of C(position, 1-based order)
+static uint64_t rankSet(uint32_t set) {
+    uint64_t r = 0;
+    for (int i = 1; set; i++, set &= set - 1) r += BINOM.c[countr_zero(set)][i];
+    return r;
+}
+
+static uint32_t unrankSet(uint64_t r, int k, int n) {
+    uint32_t set = 0;
+    for (int i = k; i >= 1; i--) {
+        int p = n - 1;
+        while (BINOM.c[p][i] > r) p--;
+        r -= BINOM.c[p][i];
+        set |= 1u << p;
+        n = p;
+    }
+    return set;
+}
+
+// Squares of 'set' renumbered among the squares of 'allowed' (and back)
+static uint32_t compress(uint32_t set, uint32_t allowed) {
+    uint32_t res = 0;
+    for (int i = 0; allowed; i++, allowed &= allowed - 1)
+        if (set & allowed & (0u - allowed)) res |= 1u << i;
+    return res;
+}
+
+static uint32_t expand(uint32_t set, uint32_t allowed) {
+    uint32_t res = 0;
+    for (int i = 0; allowed; i++, allowed &= allowed - 1)
+        if (set & (1u << i)) res |= allowed & (0u - allowed);
+    return res;
+}
+
+static uint32_t reverseBits(uint32_t v) {
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+    v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+    return (v >> 16) | (v << 16);
+}
+
+// Board turned 180 degrees (square i -> 31 - i) with the colours swapped
+static Position mirror(const Position& pos) {
+    Position m;
+    m.white = reverseBits(pos.black);
+    m.black = reverseBits(pos.white);
+    m.kings = reverseBits(pos.kings);
+    m.key = 0;
+    return m;
+}
+
+static Material materialOf(const Position& pos) {
+    return { popcount(pos.white & ~pos.kings), popcount(pos.white & pos.kings),
+             popcount(pos.black & ~pos.kings), popcount(pos.black & pos.kings) };
+}
+
+/*
+  Index of a white-to-move position inside its slice:
+  white men on squares 0..27, black men on squares 4..31 (the two may
+  collide, such indices are simply not positions), then white kings on
+  the squares without men and black kings on what is left.
+*/
+static uint64_t positionIndex(const Position& pos, const Material& m) {
+    uint32_t wMen = pos.white & ~pos.kings;
+    uint32_t bMen = pos.black & ~pos.kings;
+    uint32_t free = ~(wMen | bMen);
+    uint32_t wKings = pos.white & pos.kings;
+    int freeCount = 32 - m.wm - m.bm;
+
+    uint64_t idx = rankSet(wMen);
+    idx = idx * BINOM.c[MAN_SQUARES][m.bm] + rankSet(bMen >> 4);
+    idx = idx * BINOM.c[freeCount][m.wk] + rankSet(compress(wKings, free));
+    idx = idx * BINOM.c[freeCount - m.wk][m.bk] + rankSet(compress(pos.black & pos.kings, free & ~wKings));
+    return idx;
+}
+
+// Inverse of positionIndex; false if the index is not a position
+static bool indexPosition(uint64_t idx, const Material& m, Position& pos) {
+    int freeCount = 32 - m.wm - m.bm;
+    uint64_t nBK = BINOM.c[freeCount - m.wk][m.bk];
+    uint64_t nWK = BINOM.c[freeCount][m.wk];
+    uint64_t nBM = BINOM.c[MAN_SQUARES][m.bm];
+
+    uint64_t rBK = idx % nBK;  idx /= nBK;
+    uint64_t rWK = idx % nWK;  idx /= nWK;
+    uint64_t rBM = idx % nBM;  idx /= nBM;
+
+    uint32_t wMen = unrankSet(idx, m.wm, MAN_SQUARES);
+    uint32_t bMen = unrankSet(rBM, m.bm, MAN_SQUARES) << 4;
+    if (wMen & bMen) return false;
+
+    uint32_t free = ~(wMen | bMen);
+    uint32_t wKings = expand(unrankSet(rWK, m.wk, freeCount), free);
+    uint32_t bKings = expand(unrankSet(rBK, m.bk, freeCount - m.wk), free & ~wKings);
+
+    pos.white = wMen | wKings;
+    pos.black = bMen | bKings;
+    pos.kings = wKings | bKings;
+    refreshKey(pos);
+    return true;
+}
+
+/* ------------------ Probing ------------------ */
+
+static uint32_t readU32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint64_t readU64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+bool Tablebase::open(const char* path) {
+    pieces = 0;
+    memset(slices, 0, sizeof(slices));
+    if (!file.open(path)) return false;
+
+    const uint8_t* base = file.data();
+    size_t size = file.size();
+    if (size < HEADER_SIZE || memcmp(base, "CKTB", 4) != 0 || readU32(base + 4) != TB_VERSION) {
+        file.close();
+        return false;
+    }
+    int maxP = (int)readU32(base + 8);
+    uint32_t count = readU32(base + 12);
+    if (maxP > TB_MAX_PIECES || HEADER_SIZE + (uint64_t)count * ENTRY_SIZE > size) {
+        file.close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* e = base + HEADER_SIZE + i * ENTRY_SIZE;
+        Material m = { e[0], e[1], e[2], e[3] };
+        uint64_t offset = readU64(e + 8);
+        uint64_t bytes = readU64(e + 16);
+        if (m.wm + m.wk + m.bm + m.bk > maxP || bytes != sliceSize(m) || offset + bytes > size) {
+            file.close();
+            memset(slices, 0, sizeof(slices));
+            return false;
+        }
+        slices[m.wm][m.wk][m.bm][m.bk] = base + offset;
+    }
+    pieces = maxP;
+    return true;
+}
+
+TbResult Tablebase::probe(const Position& pos, Player side, int& plies) const {
+    if (popcount(pos.white | pos.black) > pieces) return TB_UNKNOWN;
+
+    Position p = (side == WHITE) ? pos : mirror(pos);
+    Material m = materialOf(p);
+    const uint8_t* values = slices[m.wm][m.wk][m.bm][m.bk];
+    if (!values) return TB_UNKNOWN;
+
+    uint8_t v = values[positionIndex(p, m)];
+    if (v == VALUE_DRAW) return TB_DRAW;
+    plies = v - 1;
+    return (plies & 1) ? TB_WIN : TB_LOSS;
+}
+
+/* ------------------ Generation ------------------ */
+
+/*
+  All slices are kept in memory while generating, so that moves into
+  slices solved earlier (captures, promotions) can be looked up directly.
+*/
+struct Slice {
+    Material m;
+    vector<uint8_t> values;
+};
+
+class Generator {
+public:
+    explicit Generator(int maxPieces);
+    void run();
+    bool write(const char* path) const;
+
+private:
+    void solveGroup(int a, int b);
+    uint8_t childValue(const Position& child) const;
+    void markPredecessors(const Position& solved, const Material& pm, vector<uint8_t>& dirty) const;
+    int sliceId(const Material& m) const { return ids[m.wm][m.wk][m.bm][m.bk]; }
+
+    int maxPieces;
+    vector<Slice> slices;
+    int ids[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1];
+};
+
+/*
+  Slices are solved in an order where every move leads to a slice that is
+  either already solved or part of the same group:
+  - captures lead to fewer pieces
+  - promotions lead to the same number of pieces but fewer men
+  - other moves lead to the mirrored signature (the opponent to move), so
+    a slice and its mirror are solved together
+*/
+Generator::Generator(int maxP) : maxPieces(maxP) {
+    for (auto& a : ids) for (auto& b : a) for (auto& c : b) for (int& d : c) d = -1;
+
+    for (int n = 2; n <= maxPieces; n++)
+        for (int men = 0; men <= n; men++)
+            for (int wm = 0; wm <= men; wm++)
+                for (int wk = 0; wk <= n - men; wk++) {
+                    Material m = { wm, wk, men - wm, n - men - wk };
+                    if (m.wm + m.wk == 0 || m.bm + m.bk == 0) continue;
+                    ids[m.wm][m.wk][m.bm][m.bk] = (int)slices.size();
+                    slices.push_back({ m, {} });
+                }
+}
+
+void Generator::run() {
+    for (int i = 0; i < (int)slices.size(); i++) {
+        const Material& m = slices[i].m;
+        int mirrorId = sliceId({ m.bm, m.bk, m.wm, m.wk });
+        if (mirrorId < i) continue;   // already solved with its mirror
+
+        auto start = chrono::steady_clock::now();
+        solveGroup(i, mirrorId);
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "solved %dm%dk v %dm%dk%s  %.2fs\n", m.wm, m.wk, m.bm, m.bk,
+            mirrorId != i ? " (and mirror)" : "", secs);
+    }
+}
+
+// Value of a position reached by a white move, black to move
+uint8_t Generator::childValue(const Position& child) const {
+    Position p = mirror(child);
+    if (p.white == 0) return 1;   // no pieces left: lost, 0 plies to go
+    Material m = materialOf(p);
+    return slices[sliceId(m)].values[positionIndex(p, m)];
+}
+
+/*
+  A position of the group was just solved: flag every position of the
+  group that can reach it, i.e. undo one quiet move of the side that just
+  moved (kings step back in any direction, men only backwards; moves that
+  crowned a man lead out of the group and are not undone).
+*/
+void Generator::markPredecessors(const Position& solved, const Material& pm, vector<uint8_t>& dirty) const {
+    Position x = mirror(solved);   // the position as it is right after the move
+    uint32_t empty = ~(x.white | x.black);
+    for (uint32_t w = x.white; w; w &= w - 1) {
+        int t = countr_zero(w);
+        bool king = (x.kings >> t) & 1;
+        for (int dr = -1; dr <= 1; dr += 2) {
+            if (!king && dr > 0) continue;
+            for (int dc = -1; dc <= 1; dc += 2) {
+                int r = sqRow(t) + dr, c = sqCol(t) + dc;
+                if (!inBounds(r, c) || !(empty & (1u << squareIndex(r, c)))) continue;
+
+                uint32_t bits = (1u << t) | (1u << squareIndex(r, c));
+                Position p = x;
+                p.white ^= bits;
+                if (king) p.kings ^= bits;
+                dirty[positionIndex(p, pm)] = 1;
+            }
+        }
+    }
+}
+
+/*
+  Retrograde analysis of one group of slices, in passes of increasing
+  distance. Pass d assigns every position whose exact distance is d:
+  - a win in d  if some move reaches a loss in d-1
+  - a loss in d if every move reaches a win of at most d-1 plies
+  Only positions that can have changed are looked at again: those with a
+  move into a position solved in the previous pass, and those whose moves
+  out of the group (captures, promotions, already solved) decide them at
+  exactly this pass. Whatever is never assigned is a draw.
+*/
+void Generator::solveGroup(int a, int b) {
+    int group[2] = { a, b };
+    int groupSize = (a == b) ? 1 : 2;
+
+    // Per slice of the group: flagged for this / the next pass, and the
+    // passes at which moves out of the group can make it a win / a loss
+    vector<uint8_t> dirty[2], nextDirty[2], wakeWin[2], wakeLoss[2];
+    int lastWake = 0;
+
+    // Pass 0: invalid indices, positions without moves, moves out of the group
+    for (int g = 0; g < groupSize; g++) {
+        Slice& s = slices[group[g]];
+        size_t n = sliceSize(s.m);
+        s.values.assign(n, VALUE_DRAW);
+        dirty[g].assign(n, 0);
+        nextDirty[g].assign(n, 0);
+        wakeWin[g].assign(n, 0);
+        wakeLoss[g].assign(n, 0);
+    }
+    for (int g = 0; g < groupSize; g++) {
+        Slice& s = slices[group[g]];
+        const Material& pm = slices[group[groupSize - 1 - g]].m;
+        for (uint64_t idx = 0; idx < s.values.size(); idx++) {
+            Position pos;
+            if (!indexPosition(idx, s.m, pos)) {
+                s.values[idx] = VALUE_INVALID;
+                continue;
+            }
+            MoveList moves;
+            allLegalMoves(pos, WHITE, moves);
+            if (moves.empty()) {
+                s.values[idx] = 1;
+                markPredecessors(pos, pm, nextDirty[groupSize - 1 - g]);
+                continue;
+            }
+
+            int minLoss = TB_MAX_DISTANCE + 1, maxWin = -1;
+            bool outside = false, allWins = true;
+            for (const Move& mv : moves) {
+                bool promotes = !(pos.kings & (1u << mv.from)) && sqRow(mv.to) == 7;
+                if (!mv.isCapture() && !promotes) continue;
+                Position child = pos;
+                applyMove(child, mv);
+                maybePromote(child, mv.to);
+                int v = childValue(child);
+                outside = true;
+                if (v == VALUE_DRAW) allWins = false;
+                else if ((v - 1) & 1) maxWin = max(maxWin, v - 1);
+                else { minLoss = min(minLoss, v - 1); allWins = false; }
+            }
+            if (minLoss <= TB_MAX_DISTANCE) wakeWin[g][idx] = (uint8_t)(minLoss + 1);
+            if (outside && allWins) wakeLoss[g][idx] = (uint8_t)(maxWin + 1);
+            lastWake = max({ lastWake, (int)wakeWin[g][idx], (int)wakeLoss[g][idx] });
+        }
+    }
+
+    for (int d = 1; ; d++) {
+        if (d > TB_MAX_DISTANCE) {
+            fprintf(stderr, "tbgen: distance limit exceeded\n");
+            exit(1);
+        }
+        bool pending = false;
+        for (int g = 0; g < groupSize; g++) {
+            swap(dirty[g], nextDirty[g]);
+            fill(nextDirty[g].begin(), nextDirty[g].end(), 0);
+        }
+
+        for (int g = 0; g < groupSize; g++) {
+            Slice& s = slices[group[g]];
+            int other = groupSize - 1 - g;
+            const Material& pm = slices[group[other]].m;
+            for (uint64_t idx = 0; idx < s.values.size(); idx++) {
+                if (s.values[idx] != VALUE_DRAW) continue;
+                if (!dirty[g][idx] && wakeWin[g][idx] != d && wakeLoss[g][idx] != d) continue;
+
+                Position pos;
+                indexPosition(idx, s.m, pos);
+                MoveList moves;
+                allLegalMoves(pos, WHITE, moves);
+
+                bool win = false, allWins = true;
+                for (const Move& mv : moves) {
+                    Position child = pos;
+                    applyMove(child, mv);
+                    maybePromote(child, mv.to);
+                    int v = childValue(child);
+                    int dist = v - 1;
+                    if (v == VALUE_DRAW || dist > d - 1) {
+                        allWins = false;
+                    }
+                    else if (!(dist & 1)) {
+                        win = true;
+                        break;
+                    }
+                }
+                if (win || allWins) {
+                    s.values[idx] = (uint8_t)(d + 1);
+                    markPredecessors(pos, pm, nextDirty[other]);
+                    pending = true;
+                }
+            }
+        }
+        if (!pending && d >= lastWake) break;
+    }
+}
+
+static void putU32(vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(uint8_t(v >> (8 * i)));
+}
+
+static void putU64(vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out.push_back(uint8_t(v >> (8 * i)));
+}
+
+bool Generator::write(const char* path) const {
+    vector<uint8_t> head;
+    head.insert(head.end(), { 'C', 'K', 'T', 'B' });
+    putU32(head, TB_VERSION);
+    putU32(head, (uint32_t)maxPieces);
+    putU32(head, (uint32_t)slices.size());
+
+    uint64_t offset = HEADER_SIZE + slices.size() * ENTRY_SIZE;
+    vector<uint64_t> offsets;
+    for (const Slice& s : slices) {
+        offset = (offset + 63) & ~uint64_t(63);
+        offsets.push_back(offset);
+        head.insert(head.end(), { (uint8_t)s.m.wm, (uint8_t)s.m.wk, (uint8_t)s.m.bm, (uint8_t)s.m.bk });
+        putU32(head, 0);
+        putU64(head, offset);
+        putU64(head, s.values.size());
+        offset += s.values.size();
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(head.data(), 1, head.size(), f) == head.size();
+    uint64_t at = head.size();
+    static const uint8_t zeros[64] = {};
+    for (size_t i = 0; i < slices.size() && ok; i++) {
+        // Slices are written with invalid indices turned into draws
+        vector<uint8_t> values = slices[i].values;
+        replace(values.begin(), values.end(), VALUE_INVALID, VALUE_DRAW);
+
+        ok = fwrite(zeros, 1, offsets[i] - at, f) == offsets[i] - at
+            && fwrite(values.data(), 1, values.size(), f) == values.size();
+        at = offsets[i] + values.size();
+    }
+    return fclose(f) == 0 && ok;
+}
+
+int tbGenCommand(int argc, char* argv[]) {
+    int pieces = 4;
+    const char* outPath = "checkers.tb";
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        bool ok = i + 1 < argc;
+        if (arg == "--pieces" && ok) pieces = atoi(argv[i + 1]);
+        else if (arg == "--out" && ok) outPath = argv[i + 1];
+        else {
+            fprintf(stderr, "tbgen: bad option '%s'\n", arg.c_str());
+            return 1;
+        }
+        i++;
+    }
+    if (pieces < 2 || pieces > TB_MAX_PIECES) {
+        fprintf(stderr, "tbgen: --pieces must be 2..%d\n", TB_MAX_PIECES);
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    Generator gen(pieces);
+    gen.run();
+    if (!gen.write(outPath)) {
+        fprintf(stderr, "tbgen: cannot write %s\n", outPath);
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("wrote %s (up to %d pieces) in %.1fs\n", outPath, pieces, secs);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#pragma once
+/*
+  Endgame tablebase.
+  ------------------
+  Exact results of every position with few pieces, computed offline by
+  retrograde analysis ("tbgen") and probed by the search at its leaves.
+
+  - One slice per material signature (white men, white kings, black men,
+    black kings). Only white-to-move positions are stored: a black-to-move
+    position is looked up as its mirror image (board turned 180 degrees,
+    colours swapped), which moves the same way.
+  - Each position is one byte: 0 = draw, otherwise 1 + the distance in
+    plies to the end of the game with best play (odd = the side to move
+    wins, even = it loses).
+  - Positions are indexed with the combinatorial number system: men may
+    stand on the 28 squares they can occupy, kings on the squares left
+    free by the men.
+  - All slices of one file share a single memory mapping, so opening a
+    large file is instant and only the pages the search touches are read.
+
+  Command line:
+    tbgen [--pieces N] [--out FILE]     generate all slices with <= N pieces
+                                        (default 4, at most 8)
+*/
+
+#include "Board.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+
+// Largest piece count the index scheme supports
+constexpr int TB_MAX_PIECES = 8;
+
+// Longest win or loss stored, in plies (value bytes are 1 + plies)
+constexpr int TB_MAX_DISTANCE = 253;
+
+enum TbResult {
+    TB_UNKNOWN = 0,   // not covered by the loaded tablebase
+    TB_DRAW,
+    TB_WIN,           // for the side to move
+    TB_LOSS
+};
+
+class Tablebase {
+public:
+    // Map a file written by tbgen; false if missing or malformed
+    bool open(const char* path);
+
+    bool isOpen() const { return file.isOpen(); }
+    int maxPieces() const { return pieces; }
+
+    /*
+      Result for 'side' to move; for wins and losses 'plies' receives the
+      distance to the end of the game.
+    */
+    TbResult probe(const Position& pos, Player side, int& plies) const;
+
+private:
+    MappedFile file;
+    int pieces = 0;
+    const uint8_t* slices[TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1][TB_MAX_PIECES + 1] = {};
+};
+
+int tbGenCommand(int argc, char* argv[]);
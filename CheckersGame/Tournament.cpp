@@ -0,0 +1,476 @@
+/*
+  Engine tournaments (see Tournament.h).
+*/
+
+#include "Tournament.h"
+#include "Book.h"
+#include "Eval.h"
+#include "Notation.h"
+#include "Pdn.h"
+#include "SelfPlay.h"
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+struct EngineConfig {
+    string name;
+    PlayerSpec spec;
+    EvalWeights weights = defaultEvalWeights();
+    bool ownWeights = false;   // eval= given, otherwise evalWeights()
+};
+
+struct Opening {
+    Position pos;
+    Player side;
+};
+
+/* ------------------ Statistics ------------------ */
+
+// Results of the first engine of a pair against the second
+struct MatchScore {
+    int wins = 0, draws = 0, losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    MatchScore reversed() const { return { losses, draws, wins }; }
+};
+
+static double eloFromScore(double s) {
+    s = clamp(s, 1e-6, 1.0 - 1e-6);
+    return 400.0 * log10(s / (1.0 - s));
+}
+
+static double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// Variance of the score of one game (1, 1/2 or 0)
+static double scoreVariance(const MatchScore& m) {
+    int n = m.games();
+    if (n == 0) return 0;
+    double s = m.score();
+    return (m.wins * (1 - s) * (1 - s) + m.draws * (0.5 - s) * (0.5 - s) + m.losses * s * s) / n;
+}
+
+// Elo difference and the half width of its 95% interval
+static void eloInterval(const MatchScore& m, double& elo, double& margin) {
+    double s = m.score();
+    double se = m.games() ? sqrt(scoreVariance(m) / m.games()) : 0.5;
+    elo = eloFromScore(s);
+    margin = (eloFromScore(s + 1.96 * se) - eloFromScore(s - 1.96 * se)) / 2;
+}
+
+/*
+  Log-likelihood ratio of "the Elo difference is elo1" against "it is
+  elo0", with the game scores taken as normally distributed around the
+  expected score of each hypothesis (the usual approximation).
+*/
+static double sprtLlr(const MatchScore& m, double elo0, double elo1) {
+    double var = scoreVariance(m);
+    if (var <= 0) return 0;   // no spread yet, e.g. nothing but draws
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return (s1 - s0) * (2 * m.score() - s0 - s1) * m.games() / (2 * var);
+}
+
+struct Sprt {
+    bool on = false;
+    double elo0 = 0, elo1 = 5;
+    double alpha = 0.05, beta = 0.05;
+
+    double lower() const { return log(beta / (1 - alpha)); }
+    double upper() const { return log((1 - beta) / alpha); }
+};
+
+/* ------------------ Openings ------------------ */
+
+// One FEN per line; ';' starts a comment, empty lines are skipped
+static bool readOpenings(const char* path, vector<Opening>& out) {
+    ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "tournament: cannot open %s\n", path);
+        return false;
+    }
+    string line;
+    for (int n = 1; getline(in, line); n++) {
+        string fen = line.substr(0, line.find(';'));
+        while (!fen.empty() && isspace((unsigned char)fen.back())) fen.pop_back();
+        if (fen.empty()) continue;
+        Opening op;
+        if (!parseFen(fen, op.pos, op.side)) {
+            fprintf(stderr, "tournament: %s:%d: bad FEN '%s'\n", path, n, fen.c_str());
+            return false;
+        }
+        out.push_back(op);
+    }
+    return true;
+}
+
+constexpr size_t MAX_BOOK_OPENINGS = 100000;
+
+// Every book line of 'plies' plies (or shorter where the book ends)
+static void bookOpenings(const OpeningBook& book, const Position& pos, Player side, int plies,
+                         vector<Opening>& out) {
+    if (out.size() >= MAX_BOOK_OPENINGS) return;
+    int count = 0;
+    const BookEntry* entries = plies > 0 ? book.find(positionKey(pos, side), count) : nullptr;
+    MoveList legal;
+    allLegalMoves(pos, side, legal);
+
+    bool extended = false;
+    for (int i = 0; i < count; i++) {
+        for (const Move& m : legal) {
+            if (moveCode(m) != entries[i].move) continue;
+            Position next = pos;
+            Undo undo;
+            makeMove(next, m, undo);
+            bookOpenings(book, next, opponent(side), plies - 1, out);
+            extended = true;
+            break;
+        }
+    }
+    if (!extended) out.push_back({ pos, side });
+}
+
+// Random plies from the start position; false if the game ended on the way
+static bool randomOpening(Rng& rng, int plies, Opening& out) {
+    initBoard(out.pos);
+    out.side = WHITE;
+    for (int ply = 0; ply < plies; ply++) {
+        MoveList legal;
+        allLegalMoves(out.pos, out.side, legal);
+        if (legal.empty()) return false;
+        Undo undo;
+        makeMove(out.pos, legal[rng.below(legal.size())], undo);
+        out.side = opponent(out.side);
+    }
+    MoveList legal;
+    allLegalMoves(out.pos, out.side, legal);
+    return !legal.empty();
+}
+
+/* ------------------ Threads ------------------ */
+
+static void pinToCore(int core) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % 64));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+/* ------------------ Command line ------------------ */
+
+// "name=new,eval=new.txt,depth=8,movetime=100"
+static bool parseEngine(const string& text, int index, EngineConfig& e) {
+    e.name = "engine" + to_string(index + 1);
+    e.spec.limits.maxDepth = 6;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == string::npos) end = text.size();
+        string item = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (item.empty()) continue;
+
+        size_t eq = item.find('=');
+        string key = item.substr(0, eq), val = (eq == string::npos) ? "" : item.substr(eq + 1);
+        if (val.empty()) {
+            fprintf(stderr, "tournament: '%s' needs a value in engine '%s'\n", key.c_str(), text.c_str());
+            return false;
+        }
+        if (key == "name") e.name = val;
+        else if (key == "depth") e.spec.limits.maxDepth = atoi(val.c_str());
+        else if (key == "movetime") e.spec.limits.moveTimeMs = atoi(val.c_str());
+        else if (key == "eval") {
+            string error;
+            if (!readEvalWeights(val.c_str(), e.weights, error)) {
+                fprintf(stderr, "tournament: %s\n", error.c_str());
+                return false;
+            }
+            e.ownWeights = true;
+        }
+        else {
+            fprintf(stderr, "tournament: unknown key '%s' in engine '%s'\n", key.c_str(), text.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool parseSprt(const string& text, Sprt& sprt) {
+    size_t comma = text.find(',');
+    if (comma == string::npos) return false;
+    sprt.elo0 = atof(text.substr(0, comma).c_str());
+    sprt.elo1 = atof(text.substr(comma + 1).c_str());
+    sprt.on = sprt.elo1 > sprt.elo0;
+    return sprt.on;
+}
+
+static void printPair(FILE* out, const EngineConfig& a, const EngineConfig& b, const MatchScore& m) {
+    double elo, margin;
+    eloInterval(m, elo, margin);
+    fprintf(out, "%-12s vs %-12s  +%d =%d -%d  score %5.1f%%  Elo %+.1f +/- %.1f\n", a.name.c_str(),
+        b.name.c_str(), m.wins, m.draws, m.losses, 100.0 * m.score(), elo, margin);
+}
+
+int tournamentCommand(int argc, char* argv[]) {
+    vector<EngineConfig> engines;
+    bool gauntlet = false;
+    int gamesPerPair = 100;
+    int jobs = max(1u, thread::hardware_concurrency());
+    bool pin = false;
+    size_t hashMb = 4;
+    int bookPlies = 6;
+    int randomPlies = 4;
+    int maxPlies = 400;
+    uint64_t seed = 1;
+    Sprt sprt;
+    const char* openingsPath = nullptr;
+    const char* outPath = nullptr;
+    const char* pdnPath = nullptr;
+    Tablebase tablebase;
+    OpeningBook book;
+
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--gauntlet") { gauntlet = true; continue; }
+        if (arg == "--pin") { pin = true; continue; }
+
+        string val = (i + 1 < argc) ? argv[i + 1] : "";
+        bool ok = !val.empty();
+        if (arg == "--engine" && ok) {
+            engines.emplace_back();
+            ok = parseEngine(val, (int)engines.size() - 1, engines.back());
+            if (!ok) return 1;
+        }
+        else if (arg == "--games" && ok) gamesPerPair = atoi(val.c_str());
+        else if (arg == "--jobs" && ok) jobs = max(1, atoi(val.c_str()));
+        else if (arg == "--hash" && ok) hashMb = (size_t)atoi(val.c_str());
+        else if (arg == "--tb" && ok) ok = tablebase.open(val.c_str());
+        else if (arg == "--openings" && ok) openingsPath = argv[i + 1];
+        else if (arg == "--book" && ok) ok = book.open(val.c_str());
+        else if (arg == "--book-plies" && ok) bookPlies = atoi(val.c_str());
+        else if (arg == "--random-plies" && ok) randomPlies = atoi(val.c_str());
+        else if (arg == "--max-plies" && ok) maxPlies = atoi(val.c_str());
+        else if (arg == "--seed" && ok) seed = strtoull(val.c_str(), nullptr, 10);
+        else if (arg == "--sprt" && ok) ok = parseSprt(val, sprt);
+        else if (arg == "--alpha" && ok) sprt.alpha = atof(val.c_str());
+        else if (arg == "--beta" && ok) sprt.beta = atof(val.c_str());
+        else if (arg == "--out" && ok) outPath = argv[i + 1];
+        else if (arg == "--pdn" && ok) pdnPath = argv[i + 1];
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "tournament: bad option '%s'\n", arg.c_str());
+            return 1;
+        }
+        i++;
+    }
+    if (engines.size() < 2) {
+        fprintf(stderr, "tournament: give at least two --engine options\n");
+        return 1;
+    }
+    if (sprt.on && engines.size() != 2) {
+        fprintf(stderr, "tournament: --sprt needs exactly two engines\n");
+        return 1;
+    }
+    if (!(sprt.alpha > 0 && sprt.alpha < 1 && sprt.beta > 0 && sprt.beta < 1)) {
+        fprintf(stderr, "tournament: --alpha and --beta must be between 0 and 1\n");
+        return 1;
+    }
+    for (EngineConfig& e : engines)
+        if (e.ownWeights) e.spec.weights = &e.weights;   // the vector is complete now
+
+    // Pairs: the first engine of each is the one the scores are given for
+    vector<pair<int, int>> pairs;
+    for (int a = 0; a < (int)engines.size(); a++)
+        for (int b = a + 1; b < (int)engines.size(); b++)
+            if (!gauntlet || a == 0) pairs.push_back({ a, b });
+
+    int rounds = max(1, (gamesPerPair + 1) / 2);   // one opening, both colours, every pair
+    int perRound = 2 * (int)pairs.size();
+    int totalGames = rounds * perRound;
+
+    vector<Opening> openings;
+    Rng rng(seed);
+    if (openingsPath) {
+        if (!readOpenings(openingsPath, openings)) return 1;
+    }
+    else if (book.isOpen()) {
+        Position start;
+        initBoard(start);
+        bookOpenings(book, start, WHITE, bookPlies, openings);
+        for (size_t i = openings.size(); i > 1; i--) swap(openings[i - 1], openings[rng.below((int)i)]);
+    }
+    else {
+        for (int tries = 0; (int)openings.size() < rounds && tries < 100 * rounds; tries++) {
+            Opening op;
+            if (randomOpening(rng, randomPlies, op)) openings.push_back(op);
+        }
+    }
+    if (openings.empty()) {
+        fprintf(stderr, "tournament: no opening positions\n");
+        return 1;
+    }
+
+    FILE* pdn = pdnPath ? fopen(pdnPath, "wb") : nullptr;
+    if (pdnPath && !pdn) {
+        fprintf(stderr, "tournament: cannot open %s\n", pdnPath);
+        return 1;
+    }
+
+    struct Played {
+        bool done = false;
+        int white = 0, black = 0;   // engine indices
+        GameResult result;
+    };
+    vector<Played> played(totalGames);
+    vector<MatchScore> scores(pairs.size());
+    mutex resultLock;
+    atomic<int> nextGame{ 0 };
+    atomic<bool> stopped{ false };
+    int finished = 0;
+    double llr = 0;          // SPRT state, frozen once a bound is crossed
+    int llrGames = 0;
+
+    fprintf(stderr, "tournament: %s, %d engines, up to %d games, %zu openings, %d jobs%s\n",
+        gauntlet ? "gauntlet" : "round robin", (int)engines.size(), totalGames, openings.size(), jobs,
+        pin ? " (pinned)" : "");
+
+    auto start = chrono::steady_clock::now();
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    vector<thread> pool;
+    for (int j = 0; j < jobs; j++) {
+        pool.emplace_back([&, j] {
+            if (pin) pinToCore(j % cores);
+            SelfPlayWorker worker(hashMb, true);
+            if (tablebase.isOpen()) worker.setTablebase(&tablebase);
+            SelfPlayOptions opt;
+            opt.maxPlies = maxPlies;
+            PdnGame record;
+
+            for (int g; !stopped.load(memory_order_relaxed) && (g = nextGame.fetch_add(1)) < totalGames; ) {
+                int round = g / perRound, p = (g % perRound) / 2;
+                bool swapped = (g % 2) != 0;
+                const Opening& op = openings[round % openings.size()];
+                int white = swapped ? pairs[p].second : pairs[p].first;
+                int black = swapped ? pairs[p].first : pairs[p].second;
+                opt.white = engines[white].spec;
+                opt.black = engines[black].spec;
+
+                GameResult r = worker.play(opt, op.pos, op.side, seed + (uint64_t)g, pdn ? &record.moves : nullptr);
+
+                lock_guard<mutex> lock(resultLock);
+                played[g] = { true, white, black, r };
+                MatchScore& m = scores[p];
+                if (r.winner == 0) m.draws++;
+                else if ((r.winner == WHITE) == (white == pairs[p].first)) m.wins++;
+                else m.losses++;
+                finished++;
+
+                if (pdn) {
+                    // The side moving first is called Black in PDN
+                    record.start = op.pos;
+                    record.startSide = op.side;
+                    record.result = pdnResult(r.winner);
+                    record.tags = { { "Event", "tournament" }, { "Round", to_string(g + 1) },
+                                    { "Black", engines[white].name }, { "White", engines[black].name },
+                                    { "Result", record.result } };
+                    writePdnGame(pdn, record);
+                }
+
+                // Games still running when the test ends count in the table only
+                if (sprt.on && !stopped.load(memory_order_relaxed)) {
+                    llr = sprtLlr(scores[0].reversed(), sprt.elo0, sprt.elo1);
+                    llrGames = scores[0].games();
+                    if (llr <= sprt.lower() || llr >= sprt.upper()) stopped.store(true, memory_order_relaxed);
+                }
+                if (finished % 100 == 0) {
+                    fprintf(stderr, "  %d games", finished);
+                    if (sprt.on) fprintf(stderr, "  LLR %.2f (%.2f, %.2f)", llr, sprt.lower(), sprt.upper());
+                    fprintf(stderr, "\n");
+                }
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    if (pdn) fclose(pdn);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (outPath) {
+        FILE* out = fopen(outPath, "wb");
+        if (!out) {
+            fprintf(stderr, "tournament: cannot open %s\n", outPath);
+            return 1;
+        }
+        fprintf(out, "game,white,black,winner,plies,reason\n");
+        for (int g = 0; g < totalGames; g++) {
+            const Played& pl = played[g];
+            if (!pl.done) continue;
+            fprintf(out, "%d,%s,%s,%c,%d,%s\n", g, engines[pl.white].name.c_str(), engines[pl.black].name.c_str(),
+                "DWB"[pl.result.winner], pl.result.plies, terminationName(pl.result.reason));
+        }
+        fclose(out);
+    }
+
+    printf("%d games in %.1fs (%.1f games/s)%s\n", finished, secs, secs > 0 ? finished / secs : 0.0,
+        finished < totalGames ? ", stopped early" : "");
+    for (size_t p = 0; p < pairs.size(); p++)
+        printPair(stdout, engines[pairs[p].first], engines[pairs[p].second], scores[p]);
+
+    // Points of every engine over all its games
+    if (engines.size() > 2) {
+        vector<double> points(engines.size(), 0.0);
+        vector<int> games(engines.size(), 0);
+        for (size_t p = 0; p < pairs.size(); p++) {
+            const MatchScore& m = scores[p];
+            points[pairs[p].first] += m.wins + 0.5 * m.draws;
+            points[pairs[p].second] += m.losses + 0.5 * m.draws;
+            games[pairs[p].first] += m.games();
+            games[pairs[p].second] += m.games();
+        }
+        vector<int> order(engines.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return points[a] > points[b]; });
+        printf("standings:\n");
+        for (size_t r = 0; r < order.size(); r++) {
+            int e = order[r];
+            printf("%3zu. %-12s %7.1f / %d\n", r + 1, engines[e].name.c_str(), points[e], games[e]);
+        }
+    }
+
+    if (sprt.on) {
+        const char* verdict = (llr >= sprt.upper()) ? "H1 accepted: stronger"
+            : (llr <= sprt.lower()) ? "H0 accepted: not stronger" : "inconclusive";
+        printf("SPRT %s vs %s, elo0 %.1f elo1 %.1f: LLR %.2f (%.2f, %.2f) after %d games, %s\n",
+            engines[1].name.c_str(), engines[0].name.c_str(), sprt.elo0, sprt.elo1, llr, sprt.lower(),
+            sprt.upper(), llrGames, verdict);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+/*
+  Engine tournaments.
+  -------------------
+  Plays engine configurations (evaluation weights, depth, move time)
+  against each other to answer "is this change stronger?":
+  - round robin (every pair) or gauntlet (the first engine against each
+    of the others)
+  - every opening is played twice with the colours swapped, so neither
+    engine gains from a lopsided opening
+  - openings come from a file of FEN positions, from the lines of an
+    opening book, or from random plies off the start position
+  - the games are shared out over worker threads, optionally pinned one
+    per core; each worker gives the two sides their own transposition
+    tables (see SelfPlay.h)
+  - every pair gets wins / draws / losses, score and Elo difference with
+    a 95% interval; with two engines --sprt runs a sequential probability
+    ratio test of the second (the candidate) against the first, and the
+    match stops as soon as it is decided (games still running then go in
+    the table, not in the test)
+
+  Command line:
+    tournament --engine SPEC --engine SPEC [--engine SPEC ...] [--gauntlet]
+               [--games N] [--jobs N] [--pin] [--hash MB] [--tb FILE]
+               [--openings FILE] [--book FILE] [--book-plies N] [--random-plies N]
+               [--max-plies N] [--seed S] [--sprt ELO0,ELO1] [--alpha A] [--beta B]
+               [--out FILE] [--pdn FILE]
+  SPEC is a comma-separated list of key=value: name, eval (weights file,
+  see Eval.h), depth and movetime, e.g. "name=new,eval=new.txt,depth=8".
+  --games is per pair, rounded up to an even number.
+*/
+
+int tournamentCommand(int argc, char* argv[]);
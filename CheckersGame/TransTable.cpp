@@ -0,0 +1,101 @@
+/*
+  Transposition table (see TransTable.h).
+*/
+
+#include "TransTable.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/*
+  data layout (64 bits):
+    bits  0..15  move
+    bits 16..31  score
+    bits 32..39  depth
+    bits 40..47  bound
+    bits 48..55  age
+*/
+static uint64_t pack(const TTEntry& e) {
+    return uint64_t(e.move)
+        | (uint64_t(uint16_t(e.score)) << 16)
+        | (uint64_t(uint8_t(e.depth)) << 32)
+        | (uint64_t(e.bound) << 40)
+        | (uint64_t(e.age) << 48);
+}
+
+static TTEntry unpack(uint64_t d) {
+    TTEntry e;
+    e.move = uint16_t(d);
+    e.score = int16_t(uint16_t(d >> 16));
+    e.depth = int8_t(uint8_t(d >> 32));
+    e.bound = uint8_t(d >> 40);
+    e.age = uint8_t(d >> 48);
+    return e;
+}
+
+void TransTable::resize(size_t mb) {
+    size_t want = max<size_t>(mb, 1) << 20;
+    size_t n = 1;
+    while (n * 2 * sizeof(TTBucket) <= want) n *= 2;
+
+    buckets.reset(new TTBucket[n]);
+    bucketCount = n;
+    clear();
+}
+
+void TransTable::clear() {
+    for (size_t i = 0; i < bucketCount; i++) {
+        for (TTSlot& s : buckets[i].slots) {
+            s.check.store(0, memory_order_relaxed);
+            s.data.store(0, memory_order_relaxed);
+        }
+    }
+    age.store(0, memory_order_relaxed);
+}
+
+bool TransTable::probe(uint64_t key, TTEntry& out) const {
+    const TTBucket& b = bucketFor(key);
+    for (const TTSlot& s : b.slots) {
+        uint64_t data = s.data.load(memory_order_relaxed);
+        uint64_t check = s.check.load(memory_order_relaxed);
+        if ((check ^ data) != key) continue;
+
+        out = unpack(data);
+        if (out.bound != BOUND_NONE) return true;
+    }
+    return false;
+}
+
+void TransTable::store(uint64_t key, int depth, int score, Bound bound, uint16_t move) {
+    TTBucket& b = bucketFor(key);
+    uint8_t curAge = age.load(memory_order_relaxed);
+
+    TTSlot* slot = nullptr;
+    int worst = 1 << 30;
+    for (TTSlot& s : b.slots) {
+        uint64_t data = s.data.load(memory_order_relaxed);
+        uint64_t check = s.check.load(memory_order_relaxed);
+        TTEntry e = unpack(data);
+
+        if ((check ^ data) == key) {
+            // Same position: keep a deeper result from this search
+            if (depth < e.depth && e.age == curAge && bound != BOUND_EXACT) return;
+            if (!move) move = e.move;
+            slot = &s;
+            break;
+        }
+
+        // Otherwise evict the shallowest entry, stale entries first
+        int value = (e.bound == BOUND_NONE) ? -1 : e.depth + (e.age == curAge ? 256 : 0);
+        if (value < worst) {
+            worst = value;
+            slot = &s;
+        }
+    }
+
+    TTEntry e = { move, (int16_t)score, (int8_t)depth, (uint8_t)bound, curAge };
+    uint64_t data = pack(e);
+    slot->data.store(data, memory_order_relaxed);
+    slot->check.store(key ^ data, memory_order_relaxed);
+}
@@ -0,0 +1,73 @@
+#pragma once
+/*
+  Transposition table.
+  --------------------
+  Fixed-size hash table of search results, indexed by the Zobrist key.
+  - Entries are 16 bytes, four to a 64-byte bucket, and buckets are aligned
+    to cache lines so a probe touches exactly one line.
+  - Replacement is depth-preferred: an entry for the same position is
+    overwritten, otherwise the shallowest entry of the bucket is evicted
+    (entries left over from earlier searches go first).
+  - The size is given in MB and rounded down to a power of two buckets.
+  - Lock-free: several search threads share one table. Each slot stores
+    (key ^ data) next to data; a slot torn by two concurrent writers no
+    longer XORs back to the probed key and simply reads as a miss.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// What the stored score means
+enum Bound : uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,   // score <= stored value (no move reached alpha)
+    BOUND_LOWER = 2,   // score >= stored value (beta cutoff)
+    BOUND_EXACT = 3
+};
+
+// One search result, as returned by probe()
+struct TTEntry {
+    uint16_t move;     // moveCode() of the best move, 0 if none
+    int16_t score;
+    int8_t depth;
+    uint8_t bound;
+    uint8_t age;
+};
+
+// Storage of one entry: check == key ^ data
+struct TTSlot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+};
+
+static_assert(sizeof(TTSlot) == 16, "four entries per cache line");
+
+struct alignas(64) TTBucket {
+    TTSlot slots[4];
+};
+
+class TransTable {
+public:
+    explicit TransTable(size_t mb = 64) { resize(mb); }
+
+    // Reallocate (and clear) the table to use at most 'mb' megabytes
+    void resize(size_t mb);
+    void clear();
+
+    // Called once per search so older entries are replaced first
+    void newSearch() { age.fetch_add(1, std::memory_order_relaxed); }
+
+    bool probe(uint64_t key, TTEntry& out) const;
+    void store(uint64_t key, int depth, int score, Bound bound, uint16_t move);
+
+    size_t sizeMb() const { return (bucketCount * sizeof(TTBucket)) >> 20; }
+
+private:
+    TTBucket& bucketFor(uint64_t key) const { return buckets[key & (bucketCount - 1)]; }
+
+    std::unique_ptr<TTBucket[]> buckets;
+    size_t bucketCount = 0;
+    std::atomic<uint8_t> age{ 0 };
+};
@@ -0,0 +1,86 @@
+/*
+  CPU dispatch launcher.
+  ----------------------
+  Built as "CheckersGame" when CMake is configured with CHECKERS_DISPATCH.
+  The real game is then built once for each x86-64 micro-architecture
+  level:
+    CheckersGame-x86-64      baseline (SSE2)
+    CheckersGame-x86-64-v2   + POPCNT, SSE4.2
+    CheckersGame-x86-64-v3   + AVX2, BMI1/BMI2, FMA
+    CheckersGame-x86-64-v4   + AVX-512 (F, BW, CD, DQ, VL)
+  and this program replaces itself (execv) with the highest level the CPU
+  supports, passing the arguments on unchanged. Popcounts and bit scans are
+  inlined all over the engine, so the choice has to be made for the whole
+  program rather than per function.
+
+  CHECKERS_ISA=<level> in the environment forces a level (for comparisons);
+  a level that is missing or fails to start falls back to the next lower one.
+*/
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+
+// Highest first
+static const char* const LEVELS[] = { "x86-64-v4", "x86-64-v3", "x86-64-v2", "x86-64" };
+static constexpr int LEVEL_COUNT = 4;
+
+static bool cpuSupports(const char* level) {
+    __builtin_cpu_init();
+    if (strcmp(level, "x86-64-v4") == 0)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq")
+            && __builtin_cpu_supports("avx512vl") && cpuSupports("x86-64-v3");
+    if (strcmp(level, "x86-64-v3") == 0)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")
+            && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma")
+            && cpuSupports("x86-64-v2");
+    if (strcmp(level, "x86-64-v2") == 0)
+        return __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("sse4.2")
+            && __builtin_cpu_supports("ssse3");
+    return true;
+}
+
+// Directory of this executable, with a trailing '/'
+static string selfDirectory(const char* argv0) {
+    char buf[PATH_MAX];
+    string path;
+    ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (n > 0) path.assign(buf, (size_t)n);
+    else if (realpath(argv0, buf)) path = buf;
+    else path = argv0;
+    size_t slash = path.rfind('/');
+    return (slash == string::npos) ? "./" : path.substr(0, slash + 1);
+}
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    string dir = selfDirectory(argv[0]);
+    const char* forced = getenv("CHECKERS_ISA");
+
+    int first = 0;
+    while (first < LEVEL_COUNT && !cpuSupports(LEVELS[first])) first++;
+    if (forced && *forced) {
+        int i = 0;
+        while (i < LEVEL_COUNT && strcmp(LEVELS[i], forced) != 0) i++;
+        if (i == LEVEL_COUNT) {
+            fprintf(stderr, "CheckersGame: unknown CHECKERS_ISA '%s' (x86-64, x86-64-v2, -v3 or -v4)\n", forced);
+            return 1;
+        }
+        first = i;
+    }
+
+    for (int i = first; i < LEVEL_COUNT; i++) {
+        string exe = dir + "CheckersGame-" + LEVELS[i];
+        execv(exe.c_str(), argv);   // only returns on failure
+        if (errno != ENOENT) fprintf(stderr, "CheckersGame: cannot run %s: %s\n", exe.c_str(), strerror(errno));
+    }
+    fprintf(stderr, "CheckersGame: no CheckersGame-<level> executable found in %s\n", dir.c_str());
+    return 1;
+}
@@ -0,0 +1,31 @@
+# PGO training run, invoked by the pgo-train target as
+#   cmake -D EXES=<exe;...> -D PROFILE_DIR=<dir> [-D PROFDATA=<llvm-profdata>] -P PgoTrain.cmake
+# Runs every instrumented executable through the hot paths worth
+# optimising: move generation (perft) and search (self-play). A variant the
+# CPU cannot run only produces a warning. With Clang the raw profiles are
+# then merged into PROFILE_DIR/default.profdata.
+
+foreach(exe IN LISTS EXES)
+  message(STATUS "PGO training: ${exe}")
+  foreach(args IN ITEMS "perft;test" "perft;10"
+                        "selfplay;--games;16;--white;engine;--black;engine;--depth;8;--seed;1;--out;${PROFILE_DIR}/selfplay.csv")
+    execute_process(COMMAND "${exe}" ${args}
+                    RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+      message(WARNING "PGO training: '${exe} ${args}' failed (${result})")
+    endif()
+  endforeach()
+endforeach()
+
+if(PROFDATA)
+  file(GLOB raw "${PROFILE_DIR}/*.profraw")
+  if(NOT raw)
+    message(FATAL_ERROR "PGO training: no .profraw files in ${PROFILE_DIR}")
+  endif()
+  execute_process(COMMAND "${PROFDATA}" merge -output=${PROFILE_DIR}/default.profdata ${raw}
+                  RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "PGO training: llvm-profdata merge failed")
+  endif()
+endif()
+message(STATUS "PGO training done: reconfigure with -DCHECKERS_PGO=USE and rebuild")